@@ -0,0 +1,88 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+// Hot-path profiling probes.
+//
+// Wrap a code section with PROFILE_BEGIN(id) / PROFILE_END(id) in the same
+// scope. With PROFILE_ENABLED=0 (the default) both macros compile out.
+// Durations are measured in ticks: CPU cycles from the DWT cycle counter on
+// the nRF52832, nanoseconds from clock_gettime() on host builds. The table is
+// not protected against concurrent access; only probe one execution context.
+
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED 0
+#endif
+
+// Number of log2 histogram buckets: bucket n counts durations in [2^(n-1), 2^n)
+// ticks, bucket 0 counts zero-tick durations and the last bucket is open-ended.
+#define PROFILE_HISTOGRAM_BUCKETS 24
+
+// Probe identifiers
+typedef enum {
+    PROFILE_PROBE_ADS1115_READ,  // ads1115_read_raw_data()
+    PROFILE_PROBE_I2C_WRITE,     // i2c_write()
+    PROFILE_PROBE_I2C_READ,      // i2c_read()
+    PROFILE_PROBE_FILTER_APPLY,  // glucose_filter_apply()
+    PROFILE_PROBE_COUNT
+} profile_probe_id_t;
+
+// Per-probe statistics
+typedef struct {
+    uint32_t count;
+    uint32_t min_ticks;
+    uint32_t max_ticks;
+    uint64_t total_ticks;
+    uint32_t histogram[PROFILE_HISTOGRAM_BUCKETS];
+} profile_probe_stats_t;
+
+// printf-like sink used by profile_dump() (e.g. a SEGGER_RTT_printf or NRF_LOG wrapper)
+typedef int (*profile_print_fn_t)(const char *format, ...);
+
+#if PROFILE_ENABLED
+#define PROFILE_BEGIN(id) const uint32_t profile_start_##id = profile_ticks()
+#define PROFILE_END(id)   profile_record((id), profile_ticks() - profile_start_##id)
+#else
+#define PROFILE_BEGIN(id) do { } while (0)
+#define PROFILE_END(id)   do { } while (0)
+#endif
+
+/**
+ * @brief Starts the tick source and clears the probe table.
+ */
+void profile_init(void);
+
+/**
+ * @brief Clears the probe table.
+ */
+void profile_reset(void);
+
+/**
+ * @brief Reads the free-running tick counter.
+ * @return The current tick count (wraps around).
+ */
+uint32_t profile_ticks(void);
+
+/**
+ * @brief Adds a measured duration to a probe's statistics.
+ * @param id The probe identifier.
+ * @param ticks The measured duration in ticks.
+ */
+void profile_record(profile_probe_id_t id, uint32_t ticks);
+
+/**
+ * @brief Gets a copy of a probe's statistics.
+ * @param id The probe identifier.
+ * @param stats Pointer to a structure to fill with the statistics.
+ */
+void profile_get(profile_probe_id_t id, profile_probe_stats_t *stats);
+
+/**
+ * @brief Prints the probe table: count, min, mean and max per probe, then the
+ *        non-empty histogram buckets.
+ * @param print The printf-like function used for output.
+ */
+void profile_dump(profile_print_fn_t print);
+
+#endif // PROFILE_H
@@ -0,0 +1,125 @@
+// Cortex-M only: __arm__ alone also matches 32-bit ARM Linux hosts, which have no DWT
+#if defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M')
+#define PROFILE_USE_DWT 1
+#else
+#define PROFILE_USE_DWT 0
+#endif
+
+#if !PROFILE_USE_DWT && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L // clock_gettime() on host builds
+#endif
+
+#include "profile.h"
+#include <stddef.h>
+#include <string.h>
+
+#if PROFILE_USE_DWT
+// Cortex-M4 debug registers used for cycle counting
+#define CORE_DEMCR      (*(volatile uint32_t *)0xE000EDFCu)
+#define DWT_CTRL        (*(volatile uint32_t *)0xE0001000u)
+#define DWT_CYCCNT      (*(volatile uint32_t *)0xE0001004u)
+#define DEMCR_TRCENA    (1u << 24)
+#define DWT_CYCCNTENA   (1u << 0)
+#define PROFILE_TICK_UNIT "cycles"
+#else
+#include <time.h>
+#define PROFILE_TICK_UNIT "ns"
+#endif
+
+static const char *const probe_names[PROFILE_PROBE_COUNT] = {
+    [PROFILE_PROBE_ADS1115_READ] = "ads1115_read_raw_data",
+    [PROFILE_PROBE_I2C_WRITE]    = "i2c_write",
+    [PROFILE_PROBE_I2C_READ]     = "i2c_read",
+    [PROFILE_PROBE_FILTER_APPLY] = "glucose_filter_apply",
+};
+
+static profile_probe_stats_t probe_table[PROFILE_PROBE_COUNT];
+
+// Index of the highest set bit plus one, i.e. the log2 bucket of a duration
+static uint8_t histogram_bucket(uint32_t ticks) {
+    uint8_t bucket = 0;
+    while (ticks != 0 && bucket < PROFILE_HISTOGRAM_BUCKETS - 1) {
+        ticks >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void profile_init(void) {
+#if PROFILE_USE_DWT
+    CORE_DEMCR |= DEMCR_TRCENA;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CYCCNTENA;
+#endif
+    profile_reset();
+}
+
+void profile_reset(void) {
+    memset(probe_table, 0, sizeof(probe_table));
+}
+
+uint32_t profile_ticks(void) {
+#if PROFILE_USE_DWT
+    return DWT_CYCCNT;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+#endif
+}
+
+void profile_record(profile_probe_id_t id, uint32_t ticks) {
+    if (id >= PROFILE_PROBE_COUNT) {
+        return;
+    }
+    profile_probe_stats_t *probe = &probe_table[id];
+    if (probe->count == 0 || ticks < probe->min_ticks) {
+        probe->min_ticks = ticks;
+    }
+    if (ticks > probe->max_ticks) {
+        probe->max_ticks = ticks;
+    }
+    probe->total_ticks += ticks;
+    probe->count++;
+    probe->histogram[histogram_bucket(ticks)]++;
+}
+
+void profile_get(profile_probe_id_t id, profile_probe_stats_t *stats) {
+    if (stats != NULL && id < PROFILE_PROBE_COUNT) {
+        *stats = probe_table[id];
+    }
+}
+
+void profile_dump(profile_print_fn_t print) {
+    if (print == NULL) {
+        return;
+    }
+
+    print("%-24s %10s %10s %10s %10s  (%s)\n", "probe", "count", "min", "mean", "max", PROFILE_TICK_UNIT);
+    for (uint8_t i = 0; i < PROFILE_PROBE_COUNT; i++) {
+        const profile_probe_stats_t *probe = &probe_table[i];
+        // Integer mean: the RTT/log printf implementations may lack float support
+        uint32_t mean = (probe->count > 0) ? (uint32_t)(probe->total_ticks / probe->count) : 0;
+        print("%-24s %10lu %10lu %10lu %10lu\n", probe_names[i], (unsigned long)probe->count,
+              (unsigned long)probe->min_ticks, (unsigned long)mean, (unsigned long)probe->max_ticks);
+    }
+
+    for (uint8_t i = 0; i < PROFILE_PROBE_COUNT; i++) {
+        const profile_probe_stats_t *probe = &probe_table[i];
+        if (probe->count == 0) {
+            continue;
+        }
+        print("%s histogram:\n", probe_names[i]);
+        for (uint8_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+            if (probe->histogram[b] == 0) {
+                continue;
+            }
+            unsigned long low = (b == 0) ? 0ul : (1ul << (b - 1));
+            if (b == PROFILE_HISTOGRAM_BUCKETS - 1) {
+                print("  %10lu ..           : %lu\n", low, (unsigned long)probe->histogram[b]);
+            } else {
+                print("  %10lu .. %10lu: %lu\n", low, (1ul << b) - 1, (unsigned long)probe->histogram[b]);
+            }
+        }
+    }
+}
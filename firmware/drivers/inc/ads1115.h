@@ -87,6 +87,17 @@ typedef enum {
     ADS1115_ERR_BUSY
 } ads1115_ret_code_t;
 
+// Millisecond delay used while polling for conversion completion
+typedef void (*ads1115_delay_fn_t)(uint32_t ms);
+
+/**
+ * @brief Replaces the delay used while waiting for a conversion.
+ *        Defaults to a busy-wait loop; pass a timer/OS delay (or a virtual
+ *        clock on host builds) to avoid spinning.
+ * @param fn The delay function, or NULL to restore the busy-wait default.
+ */
+void ads1115_set_delay_function(ads1115_delay_fn_t fn);
+
 /**
  * @brief Initializes the ADS1115 ADC with specified gain, sampling rate, and channel configuration.
  *        This function writes the configuration register.
@@ -123,4 +134,13 @@ ads1115_ret_code_t ads1115_read_raw_data(
  */
 ads1115_ret_code_t ads1115_set_mux(uint8_t i2c_address, ads1115_mux_t mux);
 
+/**
+ * @brief Sets the data rate used by subsequent conversions.
+ *        This does not trigger a conversion.
+ * @param i2c_address The 7-bit I2C address of the ADS1115.
+ * @param rate The new data rate (samples per second).
+ * @return ADS1115_OK on success, otherwise an error code.
+ */
+ads1115_ret_code_t ads1115_set_data_rate(uint8_t i2c_address, ads1115_sampling_rate_t rate);
+
 #endif // ADS1115_H
@@ -2,6 +2,7 @@
 #define I2C_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 // Define I2C return codes
 typedef enum {
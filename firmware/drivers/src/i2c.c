@@ -1,5 +1,7 @@
 #include "i2c.h"
+#include "profile.h"
 #include <stdbool.h>
+#include <stddef.h>
 // Placeholder for actual I2C peripheral access. 
 // This would typically involve specific microcontroller HAL/LL drivers.
 // For demonstration, these functions are stubs.
@@ -22,9 +24,11 @@ i2c_ret_code_t i2c_write(uint8_t address, const uint8_t *data, uint8_t len, bool
     (void)data;
     (void)len;
     (void)no_stop;
+    PROFILE_BEGIN(PROFILE_PROBE_I2C_WRITE);
     // In a real implementation, send start condition, address, data bytes,
     // handle ACKs, and send stop condition if no_stop is false.
     // For now, just simulate success.
+    PROFILE_END(PROFILE_PROBE_I2C_WRITE);
     return I2C_SUCCESS;
 }
 
@@ -34,6 +38,7 @@ i2c_ret_code_t i2c_read(uint8_t address, uint8_t *data, uint8_t len)
     (void)address;
     (void)data;
     (void)len;
+    PROFILE_BEGIN(PROFILE_PROBE_I2C_READ);
     // In a real implementation, send start condition, address, read data bytes,
     // send NACK for last byte, and send stop condition.
     // For now, just simulate success and fill with dummy data.
@@ -42,5 +47,6 @@ i2c_ret_code_t i2c_read(uint8_t address, uint8_t *data, uint8_t len)
             data[i] = 0x00; // Dummy data
         }
     }
+    PROFILE_END(PROFILE_PROBE_I2C_READ);
     return I2C_SUCCESS;
 }
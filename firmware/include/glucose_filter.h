@@ -2,6 +2,9 @@
 #define GLUCOSE_FILTER_H
 
 #include <stdint.h>
+#include <stdbool.h>
+
+#define MAX_FILTER_WINDOW_SIZE 10 // Maximum supported window size
 
 // Define filter types
 typedef enum {
@@ -18,6 +21,17 @@ typedef struct {
     // Add other filter-specific parameters here
 } glucose_filter_params_t;
 
+// Filter state. The glucose_filter_* functions operate on a single built-in
+// context; the glucose_filter_ctx_* variants let host tools run one
+// independent filter per stream with exactly the same arithmetic.
+typedef struct {
+    glucose_filter_params_t params;
+    float buffer[MAX_FILTER_WINDOW_SIZE];
+    uint8_t buffer_idx;
+    uint8_t buffer_fill_count;
+    bool primed; // The window has been filled once since the last init/set_params
+} glucose_filter_ctx_t;
+
 /**
  * @brief Initializes the glucose filter module.
  * @param params Pointer to the filter parameters to use.
@@ -37,10 +51,56 @@ float glucose_filter_apply(float raw_glucose);
  */
 void glucose_filter_set_params(const glucose_filter_params_t *params);
 
+/**
+ * @brief Changes the window size while keeping the most recent samples.
+ *        Unlike glucose_filter_set_params(), the history is not cleared. Once the
+ *        filter has been primed, a grown window is not refilled with raw
+ *        pass-through: the filter runs over the samples it holds until the new
+ *        window is full, so the output stays filtered when the sampling rate changes.
+ * @param window_size The new window size (1..MAX_FILTER_WINDOW_SIZE).
+ */
+void glucose_filter_resize_window(uint8_t window_size);
+
 /**
  * @brief Gets the current filter parameters.
  * @param params Pointer to a structure to fill with current parameters.
  */
 void glucose_filter_get_params(glucose_filter_params_t *params);
 
+/**
+ * @brief Initializes a filter context. See glucose_filter_init().
+ * @param ctx Pointer to the context to initialize.
+ * @param params Pointer to the filter parameters to use, or NULL for defaults.
+ */
+void glucose_filter_ctx_init(glucose_filter_ctx_t *ctx, const glucose_filter_params_t *params);
+
+/**
+ * @brief Applies a context's filter to a raw glucose value. See glucose_filter_apply().
+ * @param ctx Pointer to an initialized context.
+ * @param raw_glucose The raw glucose value to filter.
+ * @return The filtered glucose value.
+ */
+float glucose_filter_ctx_apply(glucose_filter_ctx_t *ctx, float raw_glucose);
+
+/**
+ * @brief Sets new filter parameters on a context. See glucose_filter_set_params().
+ * @param ctx Pointer to an initialized context.
+ * @param params Pointer to the new filter parameters.
+ */
+void glucose_filter_ctx_set_params(glucose_filter_ctx_t *ctx, const glucose_filter_params_t *params);
+
+/**
+ * @brief Changes a context's window size. See glucose_filter_resize_window().
+ * @param ctx Pointer to an initialized context.
+ * @param window_size The new window size (1..MAX_FILTER_WINDOW_SIZE).
+ */
+void glucose_filter_ctx_resize_window(glucose_filter_ctx_t *ctx, uint8_t window_size);
+
+/**
+ * @brief Gets a context's filter parameters. See glucose_filter_get_params().
+ * @param ctx Pointer to an initialized context.
+ * @param params Pointer to a structure to fill with current parameters.
+ */
+void glucose_filter_ctx_get_params(const glucose_filter_ctx_t *ctx, glucose_filter_params_t *params);
+
 #endif // GLUCOSE_FILTER_H
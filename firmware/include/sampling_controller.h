@@ -0,0 +1,90 @@
+#ifndef SAMPLING_CONTROLLER_H
+#define SAMPLING_CONTROLLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ads1115.h"
+
+// Acquisition levels, ordered from lowest to highest acquisition effort
+typedef enum {
+    SAMPLING_LEVEL_LOW_POWER,     // Stable glucose: slow cadence; data rate from config
+    SAMPLING_LEVEL_NORMAL,        // Default fixed schedule
+    SAMPLING_LEVEL_HIGH_DYNAMICS, // Fast change or noisy signal: fast cadence, high data rate
+    SAMPLING_LEVEL_COUNT
+} sampling_level_t;
+
+// Acquisition settings for a single level
+typedef struct {
+    ads1115_sampling_rate_t data_rate; // ADS1115 data rate used for each conversion
+    uint32_t reading_interval_ms;      // Time between two readings
+} sampling_level_config_t;
+
+// Structure to hold controller parameters
+typedef struct {
+    // Hysteresis on the rate of change of the filtered signal (mg/dL per minute).
+    // Above rate_up_threshold the controller steps up a level; it only steps down
+    // once the rate stays below rate_down_threshold.
+    float rate_up_threshold;
+    float rate_down_threshold;
+    // Same hysteresis on the noise estimate (mean |raw - filtered|, mg/dL)
+    float noise_up_threshold;
+    float noise_down_threshold;
+    // Consecutive calm readings required before stepping down a level
+    uint8_t calm_readings_to_step_down;
+    // Time span the filter window should cover; the window is rescaled on each
+    // level change so that window_size * reading_interval_ms stays close to it.
+    uint32_t filter_span_ms;
+    sampling_level_config_t levels[SAMPLING_LEVEL_COUNT];
+} sampling_controller_params_t;
+
+/**
+ * @brief Initializes the sampling controller. Starts at SAMPLING_LEVEL_NORMAL and
+ *        assumes the ADS1115 and the filter are already set up for that level.
+ * @param params Pointer to the controller parameters to use, or NULL for defaults.
+ */
+void sampling_controller_init(const sampling_controller_params_t *params);
+
+/**
+ * @brief Feeds a new reading into the controller and re-evaluates the level.
+ * @param raw_glucose The raw glucose value of the reading.
+ * @param filtered_glucose The filtered glucose value returned by glucose_filter_apply().
+ * @return true if sampling_controller_apply() should be called: the level changed,
+ *         or a previous sampling_controller_apply() failed and must be retried.
+ */
+bool sampling_controller_update(float raw_glucose, float filtered_glucose);
+
+/**
+ * @brief Pushes the current level to the ADS1115 data rate and the filter window.
+ *        The window is resized even if the ADS1115 cannot be reached; on an error
+ *        the level stays pending and sampling_controller_update() keeps returning
+ *        true until a call succeeds.
+ * @param i2c_address The 7-bit I2C address of the ADS1115.
+ * @return ADS1115_OK on success, otherwise an error code.
+ */
+ads1115_ret_code_t sampling_controller_apply(uint8_t i2c_address);
+
+/**
+ * @brief Gets the current acquisition level.
+ * @return The current level.
+ */
+sampling_level_t sampling_controller_get_level(void);
+
+/**
+ * @brief Gets the acquisition settings of the current level.
+ * @param config Pointer to a structure to fill with the current settings.
+ */
+void sampling_controller_get_level_config(sampling_level_config_t *config);
+
+/**
+ * @brief Gets the filter window size matching the current level.
+ * @return The window size (1..MAX_FILTER_WINDOW_SIZE).
+ */
+uint8_t sampling_controller_get_filter_window(void);
+
+/**
+ * @brief Gets the default controller parameters.
+ * @param params Pointer to a structure to fill with the default parameters.
+ */
+void sampling_controller_get_default_params(sampling_controller_params_t *params);
+
+#endif // SAMPLING_CONTROLLER_H
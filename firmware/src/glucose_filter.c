@@ -1,16 +1,13 @@
 #include "glucose_filter.h"
+#include "profile.h"
 #include <stddef.h>
 #include <string.h>
 
-#define MAX_FILTER_WINDOW_SIZE 10 // Maximum supported window size
-
-static glucose_filter_params_t current_filter_params;
-static float glucose_buffer[MAX_FILTER_WINDOW_SIZE];
-static uint8_t buffer_idx = 0;
-static uint8_t buffer_fill_count = 0;
+// Context behind the single-instance API used by the firmware
+static glucose_filter_ctx_t default_ctx;
 
 // Helper function for median filter (simple bubble sort for now)
-static float calculate_median(float *arr, uint8_t size) {
+static float calculate_median(const float *arr, uint8_t size) {
     if (size == 0) return 0.0f;
     if (size == 1) return arr[0];
 
@@ -34,75 +31,115 @@ static float calculate_median(float *arr, uint8_t size) {
     }
 }
 
-void glucose_filter_init(const glucose_filter_params_t *params) {
+static void clear_buffer(glucose_filter_ctx_t *ctx) {
+    memset(ctx->buffer, 0, sizeof(ctx->buffer));
+    ctx->buffer_idx = 0;
+    ctx->buffer_fill_count = 0;
+    ctx->primed = false;
+}
+
+void glucose_filter_ctx_init(glucose_filter_ctx_t *ctx, const glucose_filter_params_t *params) {
+    if (ctx == NULL) {
+        return;
+    }
     if (params != NULL) {
-        current_filter_params = *params;
-        if (current_filter_params.window_size == 0 || current_filter_params.window_size > MAX_FILTER_WINDOW_SIZE) {
-            current_filter_params.window_size = 1; // Default to 1 if invalid
+        ctx->params = *params;
+        if (ctx->params.window_size == 0 || ctx->params.window_size > MAX_FILTER_WINDOW_SIZE) {
+            ctx->params.window_size = 1; // Default to 1 if invalid
         }
     } else {
         // Default parameters if none provided
-        current_filter_params.type = FILTER_TYPE_MOVING_AVERAGE;
-        current_filter_params.window_size = 5; // Default window size
+        ctx->params.type = FILTER_TYPE_MOVING_AVERAGE;
+        ctx->params.window_size = 5; // Default window size
     }
-    // Clear the buffer
-    memset(glucose_buffer, 0, sizeof(glucose_buffer));
-    buffer_idx = 0;
-    buffer_fill_count = 0;
+    clear_buffer(ctx);
 }
 
-void glucose_filter_set_params(const glucose_filter_params_t *params) {
-    if (params != NULL) {
-        current_filter_params = *params;
-        if (current_filter_params.window_size == 0 || current_filter_params.window_size > MAX_FILTER_WINDOW_SIZE) {
-            current_filter_params.window_size = 1; // Default to 1 if invalid
+void glucose_filter_ctx_set_params(glucose_filter_ctx_t *ctx, const glucose_filter_params_t *params) {
+    if (ctx != NULL && params != NULL) {
+        ctx->params = *params;
+        if (ctx->params.window_size == 0 || ctx->params.window_size > MAX_FILTER_WINDOW_SIZE) {
+            ctx->params.window_size = 1; // Default to 1 if invalid
         }
         // Reset buffer on parameter change to avoid stale data with new window size
-        memset(glucose_buffer, 0, sizeof(glucose_buffer));
-        buffer_idx = 0;
-        buffer_fill_count = 0;
+        clear_buffer(ctx);
     }
 }
 
-void glucose_filter_get_params(glucose_filter_params_t *params) {
-    if (params != NULL) {
-        *params = current_filter_params;
+void glucose_filter_ctx_resize_window(glucose_filter_ctx_t *ctx, uint8_t window_size) {
+    if (ctx == NULL) {
+        return;
     }
+    if (window_size == 0 || window_size > MAX_FILTER_WINDOW_SIZE) {
+        window_size = 1; // Default to 1 if invalid
+    }
+    if (window_size == ctx->params.window_size) {
+        return;
+    }
+
+    // Unroll the ring buffer into chronological order (oldest first)
+    float ordered[MAX_FILTER_WINDOW_SIZE];
+    uint8_t oldest_idx = (ctx->buffer_fill_count < ctx->params.window_size) ? 0 : ctx->buffer_idx;
+    for (uint8_t i = 0; i < ctx->buffer_fill_count; i++) {
+        ordered[i] = ctx->buffer[(oldest_idx + i) % ctx->params.window_size];
+    }
+
+    // Keep only the newest samples that fit in the new window
+    uint8_t keep = (ctx->buffer_fill_count < window_size) ? ctx->buffer_fill_count : window_size;
+    memset(ctx->buffer, 0, sizeof(ctx->buffer));
+    memcpy(ctx->buffer, &ordered[ctx->buffer_fill_count - keep], keep * sizeof(float));
+
+    ctx->params.window_size = window_size;
+    ctx->buffer_fill_count = keep;
+    ctx->buffer_idx = keep % window_size;
 }
 
-float glucose_filter_apply(float raw_glucose) {
+void glucose_filter_ctx_get_params(const glucose_filter_ctx_t *ctx, glucose_filter_params_t *params) {
+    if (ctx != NULL && params != NULL) {
+        *params = ctx->params;
+    }
+}
+
+float glucose_filter_ctx_apply(glucose_filter_ctx_t *ctx, float raw_glucose) {
     // Add new value to buffer
-    glucose_buffer[buffer_idx] = raw_glucose;
-    buffer_idx = (buffer_idx + 1) % current_filter_params.window_size;
-    if (buffer_fill_count < current_filter_params.window_size) {
-        buffer_fill_count++;
+    ctx->buffer[ctx->buffer_idx] = raw_glucose;
+    ctx->buffer_idx = (ctx->buffer_idx + 1) % ctx->params.window_size;
+    if (ctx->buffer_fill_count < ctx->params.window_size) {
+        ctx->buffer_fill_count++;
+    }
+    if (ctx->buffer_fill_count == ctx->params.window_size) {
+        ctx->primed = true;
     }
 
-    if (buffer_fill_count < current_filter_params.window_size) {
+    if (!ctx->primed) {
         // Not enough data to fill the window, return raw for now or a simple average of available data
         // For simplicity, returning raw until buffer is full.
         // A more sophisticated approach might average available data or use a shorter window initially.
         return raw_glucose;
     }
 
+    // Normally the whole window; fewer after a resize to a larger window. The
+    // held samples are always buffer[0..sample_count) until the window refills.
+    uint8_t sample_count = ctx->buffer_fill_count;
+
     float filtered_value = raw_glucose; // Default to raw if no filter or not enough data
 
-    switch (current_filter_params.type) {
+    switch (ctx->params.type) {
         case FILTER_TYPE_NONE:
             filtered_value = raw_glucose;
             break;
         case FILTER_TYPE_MOVING_AVERAGE:
         {
             float sum = 0.0f;
-            for (uint8_t i = 0; i < current_filter_params.window_size; i++) {
-                sum += glucose_buffer[i];
+            for (uint8_t i = 0; i < sample_count; i++) {
+                sum += ctx->buffer[i];
             }
-            filtered_value = sum / current_filter_params.window_size;
+            filtered_value = sum / sample_count;
             break;
         }
         case FILTER_TYPE_MEDIAN:
         {
-            filtered_value = calculate_median(glucose_buffer, current_filter_params.window_size);
+            filtered_value = calculate_median(ctx->buffer, sample_count);
             break;
         }
         default:
@@ -113,3 +150,26 @@ float glucose_filter_apply(float raw_glucose) {
 
     return filtered_value;
 }
+
+void glucose_filter_init(const glucose_filter_params_t *params) {
+    glucose_filter_ctx_init(&default_ctx, params);
+}
+
+void glucose_filter_set_params(const glucose_filter_params_t *params) {
+    glucose_filter_ctx_set_params(&default_ctx, params);
+}
+
+void glucose_filter_resize_window(uint8_t window_size) {
+    glucose_filter_ctx_resize_window(&default_ctx, window_size);
+}
+
+void glucose_filter_get_params(glucose_filter_params_t *params) {
+    glucose_filter_ctx_get_params(&default_ctx, params);
+}
+
+float glucose_filter_apply(float raw_glucose) {
+    PROFILE_BEGIN(PROFILE_PROBE_FILTER_APPLY);
+    float filtered_value = glucose_filter_ctx_apply(&default_ctx, raw_glucose);
+    PROFILE_END(PROFILE_PROBE_FILTER_APPLY);
+    return filtered_value;
+}
@@ -0,0 +1,129 @@
+#include "sampling_controller.h"
+#include "glucose_filter.h"
+#include <stddef.h>
+
+#define NOISE_EWMA_ALPHA 0.25f // Weight of the newest |raw - filtered| sample
+#define MS_PER_MINUTE    60000.0f
+
+static const sampling_controller_params_t default_params = {
+    .rate_up_threshold = 2.0f,
+    .rate_down_threshold = 1.0f,
+    .noise_up_threshold = 6.0f,
+    .noise_down_threshold = 3.0f,
+    .calm_readings_to_step_down = 5,
+    .filter_span_ms = 300000, // 5 readings at the normal cadence, matching the filter default
+    .levels = {
+        // In single-shot mode a lower data rate keeps the ADC on (and the driver
+        // polling) longer per conversion, so the low power level saves energy
+        // through fewer wakeups and keeps the normal data rate.
+        [SAMPLING_LEVEL_LOW_POWER]     = { ADS1115_DR_128SPS, 150000 },
+        [SAMPLING_LEVEL_NORMAL]        = { ADS1115_DR_128SPS,  60000 },
+        [SAMPLING_LEVEL_HIGH_DYNAMICS] = { ADS1115_DR_475SPS,  30000 },
+    },
+};
+
+static sampling_controller_params_t current_params;
+static sampling_level_t current_level = SAMPLING_LEVEL_NORMAL;
+static sampling_level_t applied_level = SAMPLING_LEVEL_NORMAL; // Level last pushed to the ADC
+static float previous_filtered = 0.0f;
+static bool has_previous = false;
+static float noise_estimate = 0.0f;
+static uint8_t calm_count = 0;
+
+static float abs_f(float value) {
+    return (value < 0.0f) ? -value : value;
+}
+
+void sampling_controller_get_default_params(sampling_controller_params_t *params) {
+    if (params != NULL) {
+        *params = default_params;
+    }
+}
+
+void sampling_controller_init(const sampling_controller_params_t *params) {
+    current_params = (params != NULL) ? *params : default_params;
+    for (uint8_t i = 0; i < SAMPLING_LEVEL_COUNT; i++) {
+        if (current_params.levels[i].reading_interval_ms == 0) {
+            current_params.levels[i] = default_params.levels[i]; // Fall back if invalid
+        }
+    }
+    current_level = SAMPLING_LEVEL_NORMAL;
+    applied_level = SAMPLING_LEVEL_NORMAL;
+    previous_filtered = 0.0f;
+    has_previous = false;
+    noise_estimate = 0.0f;
+    calm_count = 0;
+}
+
+bool sampling_controller_update(float raw_glucose, float filtered_glucose) {
+    // Rate of change over the interval that separated this reading from the previous one
+    float rate = 0.0f;
+    if (has_previous) {
+        float interval_min = current_params.levels[current_level].reading_interval_ms / MS_PER_MINUTE;
+        rate = abs_f(filtered_glucose - previous_filtered) / interval_min;
+    }
+    previous_filtered = filtered_glucose;
+    has_previous = true;
+
+    noise_estimate += NOISE_EWMA_ALPHA * (abs_f(raw_glucose - filtered_glucose) - noise_estimate);
+
+    sampling_level_t new_level = current_level;
+    if (rate > current_params.rate_up_threshold || noise_estimate > current_params.noise_up_threshold) {
+        // Step up immediately so fast excursions are not missed
+        calm_count = 0;
+        if (current_level < SAMPLING_LEVEL_HIGH_DYNAMICS) {
+            new_level = (sampling_level_t)(current_level + 1);
+        }
+    } else if (rate < current_params.rate_down_threshold && noise_estimate < current_params.noise_down_threshold) {
+        // Step down only after the signal has stayed calm for a while
+        if (calm_count < UINT8_MAX) {
+            calm_count++;
+        }
+        if (calm_count >= current_params.calm_readings_to_step_down && current_level > SAMPLING_LEVEL_LOW_POWER) {
+            new_level = (sampling_level_t)(current_level - 1);
+            calm_count = 0;
+        }
+    } else {
+        // Inside the hysteresis band: hold the current level
+        calm_count = 0;
+    }
+
+    current_level = new_level;
+    // Also true while a failed sampling_controller_apply() is still pending
+    return current_level != applied_level;
+}
+
+ads1115_ret_code_t sampling_controller_apply(uint8_t i2c_address) {
+    // The window follows the reading interval, which changes with the level even
+    // if the ADC cannot be reached, so resize it before touching the bus
+    glucose_filter_resize_window(sampling_controller_get_filter_window());
+
+    ads1115_ret_code_t err_code = ads1115_set_data_rate(i2c_address, current_params.levels[current_level].data_rate);
+    if (err_code != ADS1115_OK) {
+        return err_code; // Still pending: the next update returns true again
+    }
+    applied_level = current_level;
+    return ADS1115_OK;
+}
+
+sampling_level_t sampling_controller_get_level(void) {
+    return current_level;
+}
+
+void sampling_controller_get_level_config(sampling_level_config_t *config) {
+    if (config != NULL) {
+        *config = current_params.levels[current_level];
+    }
+}
+
+uint8_t sampling_controller_get_filter_window(void) {
+    uint32_t interval_ms = current_params.levels[current_level].reading_interval_ms;
+    uint32_t window = (current_params.filter_span_ms + interval_ms / 2) / interval_ms; // Round to nearest
+
+    if (window < 1) {
+        window = 1;
+    } else if (window > MAX_FILTER_WINDOW_SIZE) {
+        window = MAX_FILTER_WINDOW_SIZE;
+    }
+    return (uint8_t)window;
+}
@@ -16,7 +16,7 @@ set(ARM_ARCH cortex-m4)
 set(ARM_FLOAT_ABI hard)
 
 # Common compiler flags
-set(COMMON_FLAGS "-mcpu=${ARM_ARCH} -mthumb -mfloat-abi=${ARM_FLOAT_ABI} -mfpu=fpv4-sp-d16")
+set(COMMON_FLAGS "-mcpu=${ARM_ARCH} -mthumb -mfloat-abi=${ARM_FLOAT_ABI} -mfpu=fpv4-sp-d16 -ffp-contract=off")
 set(CMAKE_C_FLAGS "${COMMON_FLAGS} -std=c11" CACHE STRING "C Compiler Flags")
 set(CMAKE_CXX_FLAGS "${COMMON_FLAGS} -std=c++11" CACHE STRING "C++ Compiler Flags")
 set(CMAKE_ASM_FLAGS "${COMMON_FLAGS}" CACHE STRING "ASM Compiler Flags")
@@ -0,0 +1,428 @@
+// Reruns the firmware glucose filter over many recorded streams in parallel,
+// e.g. fleet uploads after a filter parameter change. Each input is a binary
+// trace (see tools/sim/inc/trace.h); outputs use the format in batch.h.
+
+#define _POSIX_C_SOURCE 200809L // mkdir(), access()
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "cli.h"
+
+#define LIST_LINE_MAX 4096
+
+typedef struct {
+    batch_config_t config;
+    const char *output_dir;
+    const char *golden_dir;
+    bool scaling;
+    batch_stream_t *streams;
+    size_t stream_count;
+    size_t stream_capacity;
+} batch_options_t;
+
+static const char *ret_code_name(batch_ret_code_t code) {
+    switch (code) {
+        case BATCH_OK:                return "ok";
+        case BATCH_ERR_INVALID_PARAM: return "invalid parameter";
+        case BATCH_ERR_OPEN:          return "cannot open";
+        case BATCH_ERR_FORMAT:        return "not a binary trace";
+        case BATCH_ERR_WRITE:         return "cannot write output";
+        case BATCH_ERR_THREAD:        return "thread error";
+        case BATCH_ERR_GOLDEN:        return "cannot read golden file";
+        case BATCH_ERR_MISMATCH:      return "output differs from golden file";
+        default:                      return "unknown error";
+    }
+}
+
+static bool add_stream(batch_options_t *options, const char *path) {
+    if (options->stream_count == options->stream_capacity) {
+        size_t capacity = (options->stream_capacity > 0) ? options->stream_capacity * 2 : 64;
+        batch_stream_t *streams = realloc(options->streams, capacity * sizeof(*streams));
+        if (streams == NULL) {
+            return false;
+        }
+        options->streams = streams;
+        options->stream_capacity = capacity;
+    }
+    char *copy = malloc(strlen(path) + 1);
+    if (copy == NULL) {
+        return false;
+    }
+    strcpy(copy, path);
+
+    batch_stream_t *stream = &options->streams[options->stream_count++];
+    memset(stream, 0, sizeof(*stream));
+    stream->input_path = copy;
+    return true;
+}
+
+static bool add_stream_list(batch_options_t *options, const char *list_path) {
+    FILE *list = fopen(list_path, "r");
+    if (list == NULL) {
+        fprintf(stderr, "%s: cannot open list\n", list_path);
+        return false;
+    }
+    char line[LIST_LINE_MAX];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), list) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] != '\0' && line[0] != '#') {
+            ok = add_stream(options, line);
+        }
+    }
+    fclose(list);
+    return ok;
+}
+
+// Input path without extension, made relative and normalized ("/" runs and
+// "." segments dropped) so each stream keeps its own place under the output
+// directory: a/p.bin and b/p.bin map to a/p and b/p. Returns NULL for paths
+// with ".." segments, which could escape the output directory.
+static char *stream_relative_name(const char *input_path) {
+    size_t len = strlen(input_path);
+    char *name = malloc(len + 1);
+    if (name == NULL) {
+        return NULL;
+    }
+
+    size_t out = 0;
+    const char *p = input_path;
+    while (*p != '\0') {
+        size_t seg_len = strcspn(p, "/");
+        if (seg_len == 2 && p[0] == '.' && p[1] == '.') {
+            free(name);
+            return NULL;
+        }
+        if (seg_len > 0 && !(seg_len == 1 && p[0] == '.')) {
+            if (out > 0) {
+                name[out++] = '/';
+            }
+            memcpy(&name[out], p, seg_len);
+            out += seg_len;
+        }
+        p += seg_len;
+        if (*p == '/') {
+            p++;
+        }
+    }
+    name[out] = '\0';
+
+    // Strip the extension of the last segment, keeping dot files whole
+    char *base = strrchr(name, '/');
+    base = (base != NULL) ? base + 1 : name;
+    char *ext = strrchr(base, '.');
+    if (ext != NULL && ext != base) {
+        *ext = '\0';
+    }
+    if (*base == '\0') {
+        free(name);
+        return NULL;
+    }
+    return name;
+}
+
+// <dir>/<relative name><suffix>
+static char *path_under(const char *dir, const char *relative_name, const char *suffix) {
+    size_t size = strlen(dir) + 1 + strlen(relative_name) + strlen(suffix) + 1;
+    char *path = malloc(size);
+    if (path != NULL) {
+        snprintf(path, size, "%s/%s%s", dir, relative_name, suffix);
+    }
+    return path;
+}
+
+// Creates the directories leading to path, like mkdir -p on its dirname
+static bool make_parent_dirs(const char *path) {
+    char *copy = malloc(strlen(path) + 1);
+    if (copy == NULL) {
+        return false;
+    }
+    strcpy(copy, path);
+
+    bool ok = true;
+    for (char *slash = strchr(copy + 1, '/'); ok && slash != NULL; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        if (mkdir(copy, 0777) != 0 && errno != EEXIST) {
+            fprintf(stderr, "%s: cannot create directory\n", copy);
+            ok = false;
+        }
+        *slash = '/';
+    }
+    free(copy);
+    return ok;
+}
+
+static int compare_output_paths(const void *a, const void *b) {
+    const batch_stream_t *stream_a = *(const batch_stream_t *const *)a;
+    const batch_stream_t *stream_b = *(const batch_stream_t *const *)b;
+    return strcmp(stream_a->output_path, stream_b->output_path);
+}
+
+// Two streams writing the same file would overwrite, or concurrently corrupt, each other
+static bool output_paths_unique(const batch_options_t *options) {
+    const batch_stream_t **sorted = malloc(options->stream_count * sizeof(*sorted));
+    if (sorted == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < options->stream_count; i++) {
+        sorted[i] = &options->streams[i];
+    }
+    qsort(sorted, options->stream_count, sizeof(*sorted), compare_output_paths);
+
+    bool unique = true;
+    for (size_t i = 1; i < options->stream_count; i++) {
+        if (strcmp(sorted[i - 1]->output_path, sorted[i]->output_path) == 0) {
+            fprintf(stderr, "%s and %s would both write %s\n",
+                    sorted[i - 1]->input_path, sorted[i]->input_path, sorted[i]->output_path);
+            unique = false;
+        }
+    }
+    free(sorted);
+    return unique;
+}
+
+// Sets every stream's output path and prepares the directories for them
+static bool assign_output_paths(batch_options_t *options) {
+    for (size_t i = 0; i < options->stream_count; i++) {
+        batch_stream_t *stream = &options->streams[i];
+        char *relative_name = stream_relative_name(stream->input_path);
+        if (relative_name == NULL) {
+            fprintf(stderr, "%s: cannot mirror this path under %s (\"..\" segments are not supported)\n",
+                    stream->input_path, options->output_dir);
+            return false;
+        }
+        stream->output_path = path_under(options->output_dir, relative_name, ".flt");
+        free(relative_name);
+        if (stream->output_path == NULL) {
+            return false;
+        }
+    }
+    if (!output_paths_unique(options)) {
+        return false;
+    }
+    for (size_t i = 0; i < options->stream_count; i++) {
+        if (!make_parent_dirs(options->streams[i].output_path)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sets every stream's golden path: DIR/<trace path without extension>.flt, or .csv if no .flt exists
+static bool assign_golden_paths(batch_options_t *options) {
+    for (size_t i = 0; i < options->stream_count; i++) {
+        batch_stream_t *stream = &options->streams[i];
+        char *relative_name = stream_relative_name(stream->input_path);
+        if (relative_name == NULL) {
+            fprintf(stderr, "%s: cannot mirror this path under %s (\"..\" segments are not supported)\n",
+                    stream->input_path, options->golden_dir);
+            return false;
+        }
+        char *golden_path = path_under(options->golden_dir, relative_name, ".flt");
+        if (golden_path != NULL && access(golden_path, F_OK) != 0) {
+            free(golden_path);
+            golden_path = path_under(options->golden_dir, relative_name, ".csv");
+        }
+        free(relative_name);
+        if (golden_path == NULL) {
+            return false;
+        }
+        stream->golden_path = golden_path;
+    }
+    return true;
+}
+
+static void print_usage(const char *program) {
+    fprintf(stderr,
+            "usage: %s [options] <trace.bin>...\n"
+            "  --list FILE             read more trace paths from FILE, one per line\n"
+            "  --output-dir DIR        write DIR/<trace path without extension>.flt for every stream\n"
+            "  --threads N             worker threads, 1..%d (default: one per online CPU)\n"
+            "  --scaling               also run with 1, 2, 4, ... threads and report scaling\n"
+            "  --golden-dir DIR        compare every stream bit for bit with recorded device output,\n"
+            "                          DIR/<trace path without extension>.flt or .csv (trace_replay)\n"
+            "  --filter none|average|median   filter type (default average)\n"
+            "  --window N              filter window, 1..%d (default 5); windows recorded\n"
+            "                          in the trace take over from the sample they appear on\n"
+            "  --counts-per-mgdl X     ADC counts per mg/dL fed to the filter (default 50)\n",
+            program, BATCH_MAX_THREADS, MAX_FILTER_WINDOW_SIZE);
+}
+
+static bool parse_args(int argc, char **argv, batch_options_t *options) {
+    memset(options, 0, sizeof(*options));
+    options->config.filter.type = FILTER_TYPE_MOVING_AVERAGE;
+    options->config.filter.window_size = 5;
+    options->config.counts_per_mgdl = 50.0f;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (arg[0] != '-') {
+            if (!add_stream(options, arg)) {
+                return false;
+            }
+            continue;
+        }
+        if (strcmp(arg, "--scaling") == 0) {
+            options->scaling = true;
+            continue;
+        }
+
+        const char *value = (i + 1 < argc) ? argv[++i] : NULL;
+        if (value == NULL) {
+            return false;
+        }
+        if (strcmp(arg, "--list") == 0) {
+            if (!add_stream_list(options, value)) {
+                return false;
+            }
+        } else if (strcmp(arg, "--output-dir") == 0) {
+            options->output_dir = value;
+        } else if (strcmp(arg, "--golden-dir") == 0) {
+            options->golden_dir = value;
+        } else if (strcmp(arg, "--threads") == 0) {
+            unsigned long threads;
+            if (!cli_parse_ulong(value, 1, BATCH_MAX_THREADS, &threads)) {
+                return false;
+            }
+            options->config.threads = (uint32_t)threads;
+        } else if (strcmp(arg, "--filter") == 0) {
+            if (!cli_parse_filter_type(value, &options->config.filter.type)) {
+                return false;
+            }
+        } else if (strcmp(arg, "--window") == 0) {
+            unsigned long window;
+            if (!cli_parse_ulong(value, 1, MAX_FILTER_WINDOW_SIZE, &window)) {
+                return false;
+            }
+            options->config.filter.window_size = (uint8_t)window;
+        } else if (strcmp(arg, "--counts-per-mgdl") == 0) {
+            if (!cli_parse_counts_per_mgdl(value, &options->config.counts_per_mgdl)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return options->stream_count > 0;
+}
+
+static void print_run(const batch_stats_t *stats) {
+    double samples_per_s = (stats->elapsed_s > 0.0) ? stats->samples / stats->elapsed_s : 0.0;
+    double mb_per_s = (stats->elapsed_s > 0.0) ? stats->input_bytes / stats->elapsed_s / 1e6 : 0.0;
+    printf("threads                %u\n", stats->threads);
+    printf("samples                %llu\n", (unsigned long long)stats->samples);
+    printf("input                  %.1f MB\n", stats->input_bytes / 1e6);
+    printf("wall time              %.3f s\n", stats->elapsed_s);
+    printf("throughput             %.0f samples/s (%.1f MB/s)\n", samples_per_s, mb_per_s);
+    printf("steals                 %llu\n", (unsigned long long)stats->steals);
+}
+
+// Reruns the batch without output or golden checks at 1, 2, 4, ... threads up to max_threads
+static bool run_scaling(const batch_options_t *options, uint32_t max_threads) {
+    batch_stream_t *streams = malloc(options->stream_count * sizeof(*streams));
+    if (streams == NULL) {
+        return false;
+    }
+    batch_config_t config = options->config;
+    double base_rate = 0.0;
+
+    printf("\n%8s %12s %16s %9s %11s\n", "threads", "wall (s)", "samples/s", "speedup", "efficiency");
+    for (uint32_t threads = 1; ; threads = (threads * 2 > max_threads && threads < max_threads) ? max_threads : threads * 2) {
+        for (size_t i = 0; i < options->stream_count; i++) {
+            streams[i] = options->streams[i];
+            streams[i].output_path = NULL;
+            streams[i].golden_path = NULL;
+        }
+        config.threads = threads;
+        batch_stats_t stats;
+        if (batch_run(&config, streams, options->stream_count, &stats) != BATCH_OK) {
+            free(streams);
+            return false;
+        }
+        double rate = (stats.elapsed_s > 0.0) ? stats.samples / stats.elapsed_s : 0.0;
+        if (threads == 1) {
+            base_rate = rate;
+        }
+        double speedup = (base_rate > 0.0) ? rate / base_rate : 0.0;
+        printf("%8u %12.3f %16.0f %8.2fx %10.0f%%\n", stats.threads, stats.elapsed_s, rate, speedup,
+               100.0 * speedup / stats.threads);
+        if (threads >= max_threads) {
+            break;
+        }
+    }
+    free(streams);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    batch_options_t options;
+    if (!parse_args(argc, argv, &options)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    if (options.output_dir != NULL && !assign_output_paths(&options)) {
+        return 2;
+    }
+    if (options.golden_dir != NULL && !assign_golden_paths(&options)) {
+        return 2;
+    }
+
+    batch_stats_t stats;
+    if (batch_run(&options.config, options.streams, options.stream_count, &stats) != BATCH_OK) {
+        fprintf(stderr, "batch run failed\n");
+        return 1;
+    }
+
+    int exit_code = 0;
+    size_t golden_failed = 0;
+    for (size_t i = 0; i < options.stream_count; i++) {
+        const batch_stream_t *stream = &options.streams[i];
+        if (stream->status == BATCH_ERR_MISMATCH) {
+            fprintf(stderr, "%s: %s: %llu of %llu samples differ, golden has %llu samples",
+                    stream->input_path, ret_code_name(stream->status),
+                    (unsigned long long)stream->golden_mismatches, (unsigned long long)stream->samples,
+                    (unsigned long long)stream->golden_samples);
+            if (stream->golden_mismatches > 0) {
+                fprintf(stderr, " (first at sample %llu)", (unsigned long long)stream->first_mismatch);
+            }
+            fputc('\n', stderr);
+        } else if (stream->status != BATCH_OK) {
+            fprintf(stderr, "%s: %s\n", stream->input_path, ret_code_name(stream->status));
+        }
+        if (stream->status == BATCH_ERR_MISMATCH || stream->status == BATCH_ERR_GOLDEN) {
+            golden_failed++;
+        }
+        if (stream->status != BATCH_OK) {
+            exit_code = 1;
+        }
+    }
+    printf("streams                %zu (%llu failed)\n", options.stream_count,
+           (unsigned long long)stats.streams_failed);
+    print_run(&stats);
+    if (options.golden_dir != NULL) {
+        printf("golden                 %s (%zu streams differ or unreadable)\n",
+               (golden_failed == 0) ? "match" : "FAILED", golden_failed);
+    }
+
+    if (options.scaling && !run_scaling(&options, stats.threads)) {
+        fprintf(stderr, "scaling run failed\n");
+        exit_code = 1;
+    }
+
+    for (size_t i = 0; i < options.stream_count; i++) {
+        free((void *)options.streams[i].input_path);
+        free((void *)options.streams[i].output_path);
+        free((void *)options.streams[i].golden_path);
+    }
+    free(options.streams);
+    return exit_code;
+}
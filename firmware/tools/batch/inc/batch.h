@@ -0,0 +1,101 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "glucose_filter.h"
+
+// Batch reprocessing of recorded streams through the firmware glucose filter.
+//
+// Each stream is a binary trace (see tools/sim/inc/trace.h) read through a
+// memory mapping and filtered with its own glucose_filter_ctx_t, so streams
+// can be processed in parallel by a work-stealing thread pool. The filter is
+// the firmware's own glucose_filter.c, built with -ffp-contract=off as in the
+// firmware build (toolchain.cmake). Agreement with the device is not assumed:
+// give a stream a golden_path holding output recorded from a device and every
+// filtered value is compared bit for bit against it.
+//
+// Units running the adaptive sampling controller change the filter window
+// with the acquisition level. Their output is only reproducible if the trace
+// records the window per sample (trace.h); the runner then resizes the
+// stream's filter to it. Samples without a recorded window use
+// config->filter.window_size, so a unit that changed levels without logging
+// the window will not match its golden file.
+//
+// Golden files are either in the output format below or the CSV written by
+// trace_replay --output ("timestamp_s,raw_code,filtered" with %.9g values,
+// which round-trip a float exactly); the format is detected from the header.
+//
+// Output files hold the 8-byte header "GFLT" + little-endian uint32 version
+// (BATCH_OUTPUT_VERSION), then one 8-byte little-endian record per input
+// sample: uint32 timestamp_s, float filtered value (IEEE-754 bit pattern).
+
+#define BATCH_OUTPUT_MAGIC   "GFLT"
+#define BATCH_OUTPUT_VERSION 1
+#define BATCH_MAX_THREADS    256
+
+// Batch return codes
+typedef enum {
+    BATCH_OK = 0,
+    BATCH_ERR_INVALID_PARAM,
+    BATCH_ERR_OPEN,
+    BATCH_ERR_FORMAT,
+    BATCH_ERR_WRITE,
+    BATCH_ERR_THREAD,
+    BATCH_ERR_GOLDEN,    // Golden file missing or malformed
+    BATCH_ERR_MISMATCH   // Output differs from the golden file
+} batch_ret_code_t;
+
+typedef struct {
+    glucose_filter_params_t filter;
+    float counts_per_mgdl; // Raw ADC counts per mg/dL, as fed to the filter on the device
+    uint32_t threads;      // Worker threads (at most BATCH_MAX_THREADS), 0 for one per online CPU
+} batch_config_t;
+
+typedef struct {
+    const char *input_path;
+    const char *output_path;      // NULL to skip writing the filtered output
+    const char *golden_path;      // NULL to skip the comparison with recorded device output
+    // Filled in by batch_process_stream() / batch_run()
+    batch_ret_code_t status;
+    uint64_t samples;
+    uint64_t golden_mismatches;   // Samples whose timestamp or filtered bits differ
+    uint64_t first_mismatch;      // Index of the first differing sample
+    uint64_t golden_samples;      // Samples in the golden file
+} batch_stream_t;
+
+typedef struct {
+    uint32_t threads;
+    uint64_t streams_failed;
+    uint64_t samples;
+    uint64_t input_bytes;
+    uint64_t steals;              // Streams taken from another worker's queue
+    double elapsed_s;
+} batch_stats_t;
+
+/**
+ * @brief Filters one stream on the calling thread with a private filter context.
+ * @param config Pointer to the batch configuration.
+ * @param stream Pointer to the stream; status, samples and the golden results are filled in.
+ * @param input_bytes Pointer to store the size of the mapped input, or NULL.
+ * @return BATCH_OK on success, otherwise an error code (also stored in stream->status).
+ */
+batch_ret_code_t batch_process_stream(const batch_config_t *config, batch_stream_t *stream, uint64_t *input_bytes);
+
+/**
+ * @brief Filters all streams on a work-stealing thread pool.
+ * @param config Pointer to the batch configuration.
+ * @param streams Array of streams; each one is filled in as by batch_process_stream().
+ * @param count Number of streams.
+ * @param stats Pointer to store the run statistics, or NULL.
+ * @return BATCH_OK if the pool ran (check each stream's status), otherwise an error code.
+ */
+batch_ret_code_t batch_run(const batch_config_t *config, batch_stream_t *streams, size_t count, batch_stats_t *stats);
+
+/**
+ * @brief Gets the number of online CPUs.
+ * @return The CPU count, at least 1.
+ */
+uint32_t batch_cpu_count(void);
+
+#endif // BATCH_H
@@ -0,0 +1,451 @@
+#define _POSIX_C_SOURCE 200809L // mmap(), clock_gettime(), sysconf()
+
+#include "batch.h"
+#include "trace.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define OUTPUT_RECORD_SIZE   8
+#define OUTPUT_CHUNK_RECORDS 4096
+#define GOLDEN_LINE_MAX      128
+
+typedef struct {
+    const uint8_t *base;
+    size_t size;
+    const uint8_t *records;
+    uint64_t count;
+} mapped_trace_t;
+
+// Recorded device output: a mapped GFLT file or a trace_replay CSV
+typedef struct {
+    mapped_trace_t map;
+    FILE *csv;
+    uint64_t index;
+} golden_reader_t;
+
+// Per-worker queue of stream indices [top, bottom). The owner pops from the
+// bottom, thieves take from the top. Streams are coarse tasks, so a mutex per
+// queue is cheap compared to the work and keeps the pool simple.
+typedef struct {
+    pthread_mutex_t lock;
+    size_t top;
+    size_t bottom;
+    uint64_t samples;
+    uint64_t input_bytes;
+    uint64_t steals;
+    uint64_t streams_failed;
+} batch_worker_t;
+
+typedef struct {
+    const batch_config_t *config;
+    batch_stream_t *streams;
+    batch_worker_t *workers;
+    uint32_t worker_count;
+} batch_pool_t;
+
+typedef struct {
+    batch_pool_t *pool;
+    uint32_t index;
+} batch_worker_arg_t;
+
+static void write_le32(uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t float_bits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Maps a file of fixed-size records behind the 8-byte "<magic><uint32 version>" header
+// shared by binary traces and batch output
+static batch_ret_code_t map_records(const char *path, const char *magic, uint32_t version, size_t record_size,
+                                    mapped_trace_t *trace) {
+    memset(trace, 0, sizeof(*trace));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return BATCH_ERR_OPEN;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return BATCH_ERR_OPEN;
+    }
+    if (st.st_size < TRACE_HEADER_SIZE || (size_t)(st.st_size - TRACE_HEADER_SIZE) % record_size != 0) {
+        close(fd);
+        return BATCH_ERR_FORMAT;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file referenced
+    if (base == MAP_FAILED) {
+        return BATCH_ERR_OPEN;
+    }
+    posix_madvise(base, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+
+    trace->base = base;
+    trace->size = (size_t)st.st_size;
+    if (memcmp(trace->base, magic, 4) != 0 || trace_read_le32(&trace->base[4]) != version) {
+        munmap((void *)trace->base, trace->size);
+        memset(trace, 0, sizeof(*trace));
+        return BATCH_ERR_FORMAT;
+    }
+    trace->records = trace->base + TRACE_HEADER_SIZE;
+    trace->count = (trace->size - TRACE_HEADER_SIZE) / record_size;
+    return BATCH_OK;
+}
+
+static void unmap_trace(mapped_trace_t *trace) {
+    if (trace->base != NULL) {
+        munmap((void *)trace->base, trace->size);
+        trace->base = NULL;
+    }
+}
+
+static batch_ret_code_t golden_open(const char *path, golden_reader_t *golden) {
+    memset(golden, 0, sizeof(*golden));
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return BATCH_ERR_GOLDEN;
+    }
+    char magic[4];
+    bool binary = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, BATCH_OUTPUT_MAGIC, 4) == 0;
+    if (!binary) {
+        rewind(file);
+        golden->csv = file;
+        return BATCH_OK;
+    }
+    fclose(file);
+    return (map_records(path, BATCH_OUTPUT_MAGIC, BATCH_OUTPUT_VERSION, OUTPUT_RECORD_SIZE, &golden->map) == BATCH_OK) ? BATCH_OK : BATCH_ERR_GOLDEN;
+}
+
+// Reads the next "timestamp_s,raw_code,filtered" line, skipping the header, comments and blank lines
+static batch_ret_code_t golden_next_csv(golden_reader_t *golden, uint32_t *timestamp_s, uint32_t *bits, bool *end) {
+    char line[GOLDEN_LINE_MAX];
+    while (fgets(line, sizeof(line), golden->csv) != NULL) {
+        char *p = line;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') {
+            continue;
+        }
+        if (!isdigit((unsigned char)*p)) {
+            if (golden->index == 0) {
+                continue; // Column header
+            }
+            return BATCH_ERR_GOLDEN;
+        }
+
+        char *field_end;
+        errno = 0;
+        unsigned long timestamp = strtoul(p, &field_end, 10);
+        if (errno != 0 || *field_end != ',' || timestamp > UINT32_MAX) {
+            return BATCH_ERR_GOLDEN;
+        }
+        p = field_end + 1;
+        strtol(p, &field_end, 10); // raw_code: the input trace is authoritative
+        if (field_end == p || *field_end != ',') {
+            return BATCH_ERR_GOLDEN;
+        }
+        p = field_end + 1;
+        float filtered = strtof(p, &field_end);
+        if (field_end == p) {
+            return BATCH_ERR_GOLDEN;
+        }
+
+        *timestamp_s = (uint32_t)timestamp;
+        *bits = float_bits(filtered);
+        *end = false;
+        return BATCH_OK;
+    }
+    *end = true;
+    return ferror(golden->csv) ? BATCH_ERR_GOLDEN : BATCH_OK;
+}
+
+static batch_ret_code_t golden_next(golden_reader_t *golden, uint32_t *timestamp_s, uint32_t *bits, bool *end) {
+    batch_ret_code_t err_code = BATCH_OK;
+    if (golden->csv != NULL) {
+        err_code = golden_next_csv(golden, timestamp_s, bits, end);
+    } else if (golden->index < golden->map.count) {
+        const uint8_t *record = golden->map.records + golden->index * OUTPUT_RECORD_SIZE;
+        *timestamp_s = trace_read_le32(&record[0]);
+        *bits = trace_read_le32(&record[4]);
+        *end = false;
+    } else {
+        *end = true;
+    }
+    if (err_code == BATCH_OK && !*end) {
+        golden->index++;
+    }
+    return err_code;
+}
+
+static void golden_close(golden_reader_t *golden) {
+    if (golden->csv != NULL) {
+        fclose(golden->csv);
+        golden->csv = NULL;
+    }
+    unmap_trace(&golden->map);
+}
+
+// Same conversion as the device: int16 ADC code to float, then divide
+
+batch_ret_code_t batch_process_stream(const batch_config_t *config, batch_stream_t *stream, uint64_t *input_bytes) {
+    if (config == NULL || stream == NULL || stream->input_path == NULL || !(config->counts_per_mgdl > 0.0f)) {
+        return BATCH_ERR_INVALID_PARAM;
+    }
+    stream->samples = 0;
+    stream->golden_mismatches = 0;
+    stream->first_mismatch = 0;
+    stream->golden_samples = 0;
+
+    mapped_trace_t trace;
+    stream->status = map_records(stream->input_path, TRACE_BINARY_MAGIC, TRACE_BINARY_VERSION, TRACE_RECORD_SIZE, &trace);
+    if (stream->status != BATCH_OK) {
+        return stream->status;
+    }
+    if (input_bytes != NULL) {
+        *input_bytes = trace.size;
+    }
+
+    golden_reader_t golden;
+    bool has_golden = false;
+    if (stream->golden_path != NULL) {
+        stream->status = golden_open(stream->golden_path, &golden);
+        has_golden = (stream->status == BATCH_OK);
+    }
+
+    FILE *output = NULL;
+    if (stream->status == BATCH_OK && stream->output_path != NULL) {
+        output = fopen(stream->output_path, "wb");
+        uint8_t header[TRACE_HEADER_SIZE];
+        memcpy(header, BATCH_OUTPUT_MAGIC, 4);
+        write_le32(&header[4], BATCH_OUTPUT_VERSION);
+        if (output == NULL || fwrite(header, sizeof(header), 1, output) != 1) {
+            stream->status = BATCH_ERR_WRITE;
+        }
+    }
+
+    glucose_filter_ctx_t ctx;
+    glucose_filter_ctx_init(&ctx, &config->filter);
+
+    uint8_t chunk[OUTPUT_CHUNK_RECORDS * OUTPUT_RECORD_SIZE];
+    size_t chunk_records = 0;
+    bool golden_end = !has_golden;
+    uint32_t previous_timestamp_s = 0;
+    for (uint64_t i = 0; i < trace.count && stream->status == BATCH_OK; i++) {
+        trace_sample_t sample;
+        if (trace_decode_record(trace.records + i * TRACE_RECORD_SIZE, &sample) != TRACE_OK ||
+            sample.timestamp_s < previous_timestamp_s) {
+            stream->status = BATCH_ERR_FORMAT; // Same checks as trace_next()
+            break;
+        }
+        previous_timestamp_s = sample.timestamp_s;
+        if (sample.window_size != 0) {
+            glucose_filter_ctx_resize_window(&ctx, sample.window_size); // Follow the device's level changes
+        }
+        float filtered = glucose_filter_ctx_apply(&ctx, sample.raw_code / config->counts_per_mgdl);
+        uint32_t bits = float_bits(filtered);
+
+        if (!golden_end) {
+            uint32_t golden_timestamp_s;
+            uint32_t golden_bits;
+            stream->status = golden_next(&golden, &golden_timestamp_s, &golden_bits, &golden_end);
+            if (stream->status == BATCH_OK && !golden_end &&
+                (golden_timestamp_s != sample.timestamp_s || golden_bits != bits)) {
+                if (stream->golden_mismatches++ == 0) {
+                    stream->first_mismatch = i;
+                }
+            }
+        }
+
+        if (output != NULL) {
+            uint8_t *out = &chunk[chunk_records * OUTPUT_RECORD_SIZE];
+            write_le32(&out[0], sample.timestamp_s);
+            write_le32(&out[4], bits);
+            if (++chunk_records == OUTPUT_CHUNK_RECORDS) {
+                if (fwrite(chunk, OUTPUT_RECORD_SIZE, chunk_records, output) != chunk_records) {
+                    stream->status = BATCH_ERR_WRITE;
+                }
+                chunk_records = 0;
+            }
+        }
+    }
+    if (output != NULL) {
+        if (stream->status == BATCH_OK && chunk_records > 0 &&
+            fwrite(chunk, OUTPUT_RECORD_SIZE, chunk_records, output) != chunk_records) {
+            stream->status = BATCH_ERR_WRITE;
+        }
+        if (fclose(output) != 0 && stream->status == BATCH_OK) {
+            stream->status = BATCH_ERR_WRITE;
+        }
+    }
+
+    if (has_golden) {
+        // Count what is left in the golden file so a length difference is visible
+        while (stream->status == BATCH_OK && !golden_end) {
+            uint32_t unused_timestamp_s;
+            uint32_t unused_bits;
+            stream->status = golden_next(&golden, &unused_timestamp_s, &unused_bits, &golden_end);
+        }
+        stream->golden_samples = golden.index;
+        golden_close(&golden);
+        if (stream->status == BATCH_OK && (stream->golden_mismatches > 0 || stream->golden_samples != trace.count)) {
+            stream->status = BATCH_ERR_MISMATCH;
+        }
+    }
+    unmap_trace(&trace);
+
+    if (stream->status == BATCH_OK || stream->status == BATCH_ERR_MISMATCH) {
+        stream->samples = trace.count;
+    }
+    return stream->status;
+}
+
+// Takes the next stream index: own queue first, then steal from the others
+static bool next_stream(batch_pool_t *pool, uint32_t self, size_t *index) {
+    batch_worker_t *own = &pool->workers[self];
+    bool found = false;
+
+    pthread_mutex_lock(&own->lock);
+    if (own->bottom > own->top) {
+        *index = --own->bottom;
+        found = true;
+    }
+    pthread_mutex_unlock(&own->lock);
+    if (found) {
+        return true;
+    }
+
+    // No task is ever added after start, so once every queue is empty we are done
+    for (uint32_t n = 1; n < pool->worker_count && !found; n++) {
+        batch_worker_t *victim = &pool->workers[(self + n) % pool->worker_count];
+        pthread_mutex_lock(&victim->lock);
+        if (victim->bottom > victim->top) {
+            *index = victim->top++;
+            found = true;
+        }
+        pthread_mutex_unlock(&victim->lock);
+    }
+    if (found) {
+        own->steals++;
+    }
+    return found;
+}
+
+static void *worker_main(void *arg) {
+    batch_worker_arg_t *worker_arg = arg;
+    batch_pool_t *pool = worker_arg->pool;
+    batch_worker_t *worker = &pool->workers[worker_arg->index];
+
+    size_t index;
+    while (next_stream(pool, worker_arg->index, &index)) {
+        uint64_t input_bytes = 0;
+        batch_ret_code_t err_code = batch_process_stream(pool->config, &pool->streams[index], &input_bytes);
+        if (err_code == BATCH_OK || err_code == BATCH_ERR_MISMATCH) {
+            worker->samples += pool->streams[index].samples;
+            worker->input_bytes += input_bytes;
+        }
+        if (err_code != BATCH_OK) {
+            worker->streams_failed++;
+        }
+    }
+    return NULL;
+}
+
+uint32_t batch_cpu_count(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return (cpus > 0) ? (uint32_t)cpus : 1;
+}
+
+batch_ret_code_t batch_run(const batch_config_t *config, batch_stream_t *streams, size_t count, batch_stats_t *stats) {
+    if (config == NULL || (streams == NULL && count > 0) || config->threads > BATCH_MAX_THREADS) {
+        return BATCH_ERR_INVALID_PARAM;
+    }
+
+    uint32_t worker_count = (config->threads != 0) ? config->threads : batch_cpu_count();
+    if (worker_count > BATCH_MAX_THREADS) {
+        worker_count = BATCH_MAX_THREADS;
+    }
+    if (count > 0 && worker_count > count) {
+        worker_count = (uint32_t)count; // Idle workers would only contend for steals
+    }
+    if (worker_count == 0) {
+        worker_count = 1;
+    }
+
+    batch_pool_t pool = { config, streams, NULL, worker_count };
+    pool.workers = calloc(worker_count, sizeof(*pool.workers));
+    batch_worker_arg_t *args = calloc(worker_count, sizeof(*args));
+    pthread_t *threads = calloc(worker_count, sizeof(*threads));
+    if (pool.workers == NULL || args == NULL || threads == NULL) {
+        free(pool.workers);
+        free(args);
+        free(threads);
+        return BATCH_ERR_THREAD;
+    }
+
+    // Give each worker a contiguous slice of the streams
+    for (uint32_t i = 0; i < worker_count; i++) {
+        pthread_mutex_init(&pool.workers[i].lock, NULL);
+        pool.workers[i].top = count * i / worker_count;
+        pool.workers[i].bottom = count * (i + 1) / worker_count;
+        args[i].pool = &pool;
+        args[i].index = i;
+    }
+
+    double start_s = now_s();
+    uint32_t started = 0;
+    while (started < worker_count && pthread_create(&threads[started], NULL, worker_main, &args[started]) == 0) {
+        started++;
+    }
+    if (started == 0) {
+        worker_main(&args[0]); // Could not start any thread: run inline, stealing every slice
+    }
+    // If only some threads started, they steal the slices of the missing ones
+    for (uint32_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double elapsed_s = now_s() - start_s;
+
+    if (stats != NULL) {
+        memset(stats, 0, sizeof(*stats));
+        stats->threads = (started > 0) ? started : 1;
+        stats->elapsed_s = elapsed_s;
+        for (uint32_t i = 0; i < worker_count; i++) {
+            stats->samples += pool.workers[i].samples;
+            stats->input_bytes += pool.workers[i].input_bytes;
+            stats->steals += pool.workers[i].steals;
+            stats->streams_failed += pool.workers[i].streams_failed;
+        }
+    }
+
+    for (uint32_t i = 0; i < worker_count; i++) {
+        pthread_mutex_destroy(&pool.workers[i].lock);
+    }
+    free(pool.workers);
+    free(args);
+    free(threads);
+    return BATCH_OK;
+}
@@ -0,0 +1,207 @@
+// Host simulation comparing the adaptive sampling controller against the fixed
+// acquisition schedule. Both runs go through the real ADS1115 driver and
+// glucose filter on top of the simulated I2C bus, over the same synthetic
+// glucose trace, and report energy proxies (I2C traffic, conversions, wakeups)
+// together with the tracking error of the filtered output.
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ads1115.h"
+#include "glucose_filter.h"
+#include "i2c_sim.h"
+#include "sim_clock.h"
+#include "sampling_controller.h"
+
+#define SIM_I2C_ADDRESS       ADS1115_ADDRESS_GND
+#define SIM_COUNTS_PER_MGDL   50.0f  // Sensor front-end gain: 110 mg/dL -> 5500 counts
+#define SIM_BASELINE_MGDL     110.0f
+#define SIM_NOISE_SD_MGDL     1.5f
+#define SIM_ARTIFACT_SD_MGDL  12.0f  // Compression artifact noise level
+#define MS_PER_HOUR           3600000ULL
+#define MS_PER_MINUTE         60000.0
+#define TWO_PI                6.283185307179586
+
+typedef struct {
+    uint32_t wakeups;
+    uint32_t level_changes;
+    uint64_t time_in_level_ms[SAMPLING_LEVEL_COUNT];
+    double abs_error_sum;
+    float max_abs_error;
+    uint32_t errors;
+    i2c_sim_stats_t bus;
+} sim_result_t;
+
+static uint32_t rng_state;
+
+static uint32_t xorshift32(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// Standard normal sample (Box-Muller)
+static float gaussian(void) {
+    double u1 = (xorshift32() + 1.0) / 4294967297.0;
+    double u2 = (xorshift32() + 1.0) / 4294967297.0;
+    return (float)(sqrt(-2.0 * log(u1)) * cos(TWO_PI * u2));
+}
+
+// Meal response: rises to peak_mgdl after tau_min, then decays
+static float meal_response(double t_min, double start_min, float peak_mgdl, double tau_min) {
+    double x = (t_min - start_min) / tau_min;
+    if (x <= 0.0) {
+        return 0.0f;
+    }
+    return (float)(peak_mgdl * x * exp(1.0 - x));
+}
+
+// Synthetic daily profile: three meals and a noisy compression artifact at night
+static float true_glucose(uint64_t t_ms, float *noise_sd) {
+    double t_min = fmod(t_ms / MS_PER_MINUTE, 24.0 * 60.0);
+    float glucose = SIM_BASELINE_MGDL;
+    glucose += meal_response(t_min, 7.0 * 60.0, 70.0f, 45.0);
+    glucose += meal_response(t_min, 12.5 * 60.0, 90.0f, 50.0);
+    glucose += meal_response(t_min, 19.0 * 60.0, 80.0f, 45.0);
+
+    bool artifact = (t_min >= 2.0 * 60.0 && t_min < 2.5 * 60.0);
+    *noise_sd = artifact ? SIM_ARTIFACT_SD_MGDL : SIM_NOISE_SD_MGDL;
+    return glucose;
+}
+
+static int run_schedule(bool adaptive, uint64_t duration_ms, uint32_t seed, sim_result_t *result) {
+    memset(result, 0, sizeof(*result));
+    rng_state = seed;
+
+    sim_clock_reset();
+    ads1115_set_delay_function(sim_clock_delay_ms);
+    i2c_init(0, 0, 400000);
+    if (ads1115_init(SIM_I2C_ADDRESS, ADS1115_PGA_4_096V, ADS1115_DR_128SPS, ADS1115_MUX_P0_NG) != ADS1115_OK) {
+        return -1;
+    }
+    glucose_filter_init(NULL);
+    sampling_controller_init(NULL);
+    i2c_sim_clear_stats(); // Only count steady-state acquisition traffic
+
+    uint64_t t_ms = 0;
+    while (t_ms < duration_ms) {
+        sim_clock_advance_to_us(t_ms * 1000);
+        float noise_sd;
+        float truth = true_glucose(t_ms, &noise_sd);
+        float sensed = truth + noise_sd * gaussian();
+        i2c_sim_set_conversion_value((int16_t)lroundf(sensed * SIM_COUNTS_PER_MGDL));
+
+        result->wakeups++;
+        int16_t raw_code;
+        if (ads1115_read_raw_data(SIM_I2C_ADDRESS, &raw_code) != ADS1115_OK) {
+            return -1;
+        }
+        float raw_glucose = raw_code / SIM_COUNTS_PER_MGDL;
+        float filtered = glucose_filter_apply(raw_glucose);
+
+        float abs_error = fabsf(filtered - truth);
+        result->abs_error_sum += abs_error;
+        result->errors++;
+        if (abs_error > result->max_abs_error) {
+            result->max_abs_error = abs_error;
+        }
+
+        sampling_level_config_t level_config;
+        sampling_controller_get_level_config(&level_config);
+        uint32_t interval_ms = level_config.reading_interval_ms;
+        if (adaptive) {
+            result->time_in_level_ms[sampling_controller_get_level()] += interval_ms;
+            if (sampling_controller_update(raw_glucose, filtered)) {
+                result->level_changes++;
+                if (sampling_controller_apply(SIM_I2C_ADDRESS) != ADS1115_OK) {
+                    return -1;
+                }
+            }
+        } else {
+            result->time_in_level_ms[SAMPLING_LEVEL_NORMAL] += interval_ms;
+        }
+        t_ms += interval_ms;
+    }
+
+    i2c_sim_get_stats(&result->bus);
+    return 0;
+}
+
+static double percent_of(double value, double reference) {
+    return (reference > 0.0) ? 100.0 * value / reference : 0.0;
+}
+
+static void print_comparison(const sim_result_t *fixed, const sim_result_t *adaptive) {
+    static const char *level_names[SAMPLING_LEVEL_COUNT] = { "low power", "normal", "high dynamics" };
+    uint64_t fixed_bytes = (uint64_t)fixed->bus.bytes_written + fixed->bus.bytes_read;
+    uint64_t adaptive_bytes = (uint64_t)adaptive->bus.bytes_written + adaptive->bus.bytes_read;
+
+    printf("%-26s %14s %14s %9s\n", "metric", "fixed", "adaptive", "ratio");
+    printf("%-26s %14u %14u %8.1f%%\n", "wakeups", fixed->wakeups, adaptive->wakeups,
+           percent_of(adaptive->wakeups, fixed->wakeups));
+    printf("%-26s %14u %14u %8.1f%%\n", "ADC conversions", fixed->bus.conversions, adaptive->bus.conversions,
+           percent_of(adaptive->bus.conversions, fixed->bus.conversions));
+    printf("%-26s %14llu %14llu %8.1f%%\n", "ADC active time (us)",
+           (unsigned long long)fixed->bus.adc_active_us, (unsigned long long)adaptive->bus.adc_active_us,
+           percent_of((double)adaptive->bus.adc_active_us, (double)fixed->bus.adc_active_us));
+    printf("%-26s %14u %14u %8.1f%%\n", "I2C transfers", fixed->bus.transfers, adaptive->bus.transfers,
+           percent_of(adaptive->bus.transfers, fixed->bus.transfers));
+    printf("%-26s %14llu %14llu %8.1f%%\n", "I2C bytes",
+           (unsigned long long)fixed_bytes, (unsigned long long)adaptive_bytes,
+           percent_of((double)adaptive_bytes, (double)fixed_bytes));
+    printf("%-26s %14.2f %14.2f\n", "mean |error| (mg/dL)",
+           fixed->abs_error_sum / fixed->errors, adaptive->abs_error_sum / adaptive->errors);
+    printf("%-26s %14.2f %14.2f\n", "max |error| (mg/dL)", fixed->max_abs_error, adaptive->max_abs_error);
+    printf("%-26s %14u %14u\n", "level changes", fixed->level_changes, adaptive->level_changes);
+
+    uint64_t total_ms = 0;
+    for (int i = 0; i < SAMPLING_LEVEL_COUNT; i++) {
+        total_ms += adaptive->time_in_level_ms[i];
+    }
+    printf("\nadaptive time per level:\n");
+    for (int i = 0; i < SAMPLING_LEVEL_COUNT; i++) {
+        printf("  %-14s %6.1f%%\n", level_names[i], percent_of((double)adaptive->time_in_level_ms[i], (double)total_ms));
+    }
+}
+
+static void print_usage(const char *program) {
+    fprintf(stderr, "usage: %s [--hours N] [--seed N]\n", program);
+}
+
+int main(int argc, char **argv) {
+    unsigned long hours = 24;
+    uint32_t seed = 0x1234567u;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--hours") == 0 && i + 1 < argc) {
+            hours = strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+    if (hours == 0 || seed == 0) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    sim_result_t fixed;
+    sim_result_t adaptive;
+    uint64_t duration_ms = hours * MS_PER_HOUR;
+    if (run_schedule(false, duration_ms, seed, &fixed) != 0 ||
+        run_schedule(true, duration_ms, seed, &adaptive) != 0) {
+        fprintf(stderr, "simulation failed: ADS1115 driver returned an error\n");
+        return 1;
+    }
+
+    printf("simulated %lu h, seed 0x%08x\n\n", hours, seed);
+    print_comparison(&fixed, &adaptive);
+    return 0;
+}
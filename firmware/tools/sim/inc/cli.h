@@ -0,0 +1,44 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include <stdbool.h>
+#include "glucose_filter.h"
+
+// Command-line option parsing shared by the host tools.
+
+/**
+ * @brief Parses an unsigned decimal integer. The whole value must be digits:
+ *        no sign, no surrounding blanks, no trailing characters.
+ * @param text The option value.
+ * @param min Smallest accepted value.
+ * @param max Largest accepted value.
+ * @param value Pointer to store the parsed value.
+ * @return true on success, false if the value is malformed or out of range.
+ */
+bool cli_parse_ulong(const char *text, unsigned long min, unsigned long max, unsigned long *value);
+
+/**
+ * @brief Parses a finite floating-point number. The whole value must be consumed.
+ * @param text The option value.
+ * @param value Pointer to store the parsed value.
+ * @return true on success, false if the value is malformed, infinite or NaN.
+ */
+bool cli_parse_double(const char *text, double *value);
+
+/**
+ * @brief Parses a counts-per-mg/dL scale: a finite number above 0 that fits a float.
+ * @param text The option value.
+ * @param value Pointer to store the parsed value.
+ * @return true on success, false otherwise.
+ */
+bool cli_parse_counts_per_mgdl(const char *text, float *value);
+
+/**
+ * @brief Parses a filter type name: "none", "average" or "median".
+ * @param text The option value.
+ * @param type Pointer to store the filter type.
+ * @return true on success, false if the name is unknown.
+ */
+bool cli_parse_filter_type(const char *text, glucose_filter_type_t *type);
+
+#endif // CLI_H
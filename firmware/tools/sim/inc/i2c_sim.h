@@ -0,0 +1,49 @@
+#ifndef I2C_SIM_H
+#define I2C_SIM_H
+
+#include <stdint.h>
+#include "i2c.h"
+
+// Host implementation of the i2c.h API that emulates an ADS1115 on the bus.
+// Every address answers as the same ADS1115. Bus transfers and conversions
+// take time on the virtual clock (sim_clock.h); install sim_clock_delay_ms()
+// with ads1115_set_delay_function() so the driver's polling advances it too.
+
+// Bus and ADC activity counters, used as energy proxies
+typedef struct {
+    uint32_t transfers;       // Number of i2c_write()/i2c_read() calls
+    uint32_t bytes_written;   // Payload bytes written (address byte excluded)
+    uint32_t bytes_read;      // Payload bytes read (address byte excluded)
+    uint32_t conversions;     // Single-shot conversions started
+    uint64_t adc_active_us;   // Sum of nominal conversion times
+} i2c_sim_stats_t;
+
+/**
+ * @brief Resets the emulated ADS1115 to its power-on state and clears the counters.
+ */
+void i2c_sim_reset(void);
+
+/**
+ * @brief Sets the value latched into the conversion register by the next conversion.
+ * @param value The raw 16-bit ADC code.
+ */
+void i2c_sim_set_conversion_value(int16_t value);
+
+/**
+ * @brief Makes the next transfers fail as if the ADS1115 did not acknowledge its address.
+ * @param count Number of i2c_write()/i2c_read() calls to fail, 0 to stop failing.
+ */
+void i2c_sim_fail_next_transfers(uint32_t count);
+
+/**
+ * @brief Gets the bus and ADC activity counters.
+ * @param stats Pointer to a structure to fill with the counters.
+ */
+void i2c_sim_get_stats(i2c_sim_stats_t *stats);
+
+/**
+ * @brief Clears the bus and ADC activity counters without touching the device state.
+ */
+void i2c_sim_clear_stats(void);
+
+#endif // I2C_SIM_H
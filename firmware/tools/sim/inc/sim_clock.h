@@ -0,0 +1,38 @@
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdint.h>
+
+// Virtual clock shared by the simulated peripherals. Time only moves when
+// the simulation advances it, so host runs are as fast as the CPU allows.
+
+/**
+ * @brief Resets the virtual clock to zero.
+ */
+void sim_clock_reset(void);
+
+/**
+ * @brief Gets the current virtual time.
+ * @return Microseconds since the last reset.
+ */
+uint64_t sim_clock_now_us(void);
+
+/**
+ * @brief Advances the virtual clock.
+ * @param us Number of microseconds to advance.
+ */
+void sim_clock_advance_us(uint64_t us);
+
+/**
+ * @brief Advances the virtual clock to an absolute time; no-op if already past it.
+ * @param us Target time in microseconds since the last reset.
+ */
+void sim_clock_advance_to_us(uint64_t us);
+
+/**
+ * @brief Delay function for ads1115_set_delay_function() backed by the virtual clock.
+ * @param ms Number of milliseconds to advance.
+ */
+void sim_clock_delay_ms(uint32_t ms);
+
+#endif // SIM_CLOCK_H
@@ -0,0 +1,93 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// Recorded sensor traces, one ADC reading per sample.
+//
+// CSV: one "timestamp_s,raw_code[,window_size]" line per sample. Blank lines,
+// lines starting with '#' and a non-numeric header line are skipped.
+//
+// Binary: the 8-byte header "GTRC" followed by a little-endian uint32
+// version (TRACE_BINARY_VERSION), then 8-byte little-endian records:
+//   uint32 timestamp_s, int16 raw_code, uint8 window_size, uint8 reserved (0).
+//
+// window_size is the filter window the device applied to the reading, which
+// the adaptive sampling controller changes with the acquisition level; the
+// replay tools resize their filter to it so such recordings reproduce the
+// device output. 0 (or a missing CSV column) means not recorded: the replay
+// keeps its configured window. Traces written before the field existed had
+// 0 in its place and still read the same.
+// The format is detected from the header, not from the file extension.
+// In both formats timestamps must not decrease; a sample earlier than the
+// previous one is reported as TRACE_ERR_FORMAT.
+
+#define TRACE_BINARY_MAGIC   "GTRC"
+#define TRACE_BINARY_VERSION 1
+#define TRACE_HEADER_SIZE    8 // Magic + version
+#define TRACE_RECORD_SIZE    8
+
+// Trace return codes
+typedef enum {
+    TRACE_OK = 0,
+    TRACE_END,          // No more samples
+    TRACE_ERR_OPEN,
+    TRACE_ERR_FORMAT
+} trace_ret_code_t;
+
+typedef struct {
+    uint32_t timestamp_s; // Time of the reading, seconds since the start of the recording
+    int16_t raw_code;     // Raw ADS1115 conversion result
+    uint8_t window_size;  // Filter window used on the device (1..MAX_FILTER_WINDOW_SIZE), 0 if not recorded
+} trace_sample_t;
+
+typedef struct {
+    FILE *file;
+    bool binary;
+    uint32_t line;        // Current line (CSV) or record (binary), for error messages
+    uint32_t last_timestamp_s;
+    bool has_sample;
+} trace_reader_t;
+
+/**
+ * @brief Opens a trace file and detects its format.
+ * @param reader Pointer to the reader to initialize.
+ * @param path Path of the trace file.
+ * @return TRACE_OK on success, otherwise an error code.
+ */
+trace_ret_code_t trace_open(trace_reader_t *reader, const char *path);
+
+/**
+ * @brief Reads the next sample of the trace.
+ * @param reader Pointer to an open reader.
+ * @param sample Pointer to store the sample.
+ * @return TRACE_OK on success, TRACE_END at the end of the trace, otherwise an error code.
+ */
+trace_ret_code_t trace_next(trace_reader_t *reader, trace_sample_t *sample);
+
+/**
+ * @brief Reads a little-endian uint32, as stored in binary trace headers and records.
+ * @param bytes Pointer to 4 bytes.
+ * @return The decoded value.
+ */
+uint32_t trace_read_le32(const uint8_t *bytes);
+
+/**
+ * @brief Decodes one binary trace record, e.g. from a memory-mapped trace.
+ *        trace_next() uses the same decoding. Does not check the timestamp
+ *        order, which needs the previous record.
+ * @param record Pointer to TRACE_RECORD_SIZE bytes.
+ * @param sample Pointer to store the sample.
+ * @return TRACE_OK on success, TRACE_ERR_FORMAT if the window size is out of range.
+ */
+trace_ret_code_t trace_decode_record(const uint8_t *record, trace_sample_t *sample);
+
+/**
+ * @brief Closes a trace file.
+ * @param reader Pointer to the reader to close.
+ */
+void trace_close(trace_reader_t *reader);
+
+#endif // TRACE_H
@@ -0,0 +1,57 @@
+#include "cli.h"
+#include <ctype.h>
+#include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool cli_parse_ulong(const char *text, unsigned long min, unsigned long max, unsigned long *value) {
+    // strtoul() would accept leading blanks and a sign, wrapping "-1" to ULONG_MAX
+    if (!isdigit((unsigned char)text[0])) {
+        return false;
+    }
+    char *end;
+    errno = 0;
+    unsigned long parsed = strtoul(text, &end, 10);
+    if (errno != 0 || *end != '\0' || parsed < min || parsed > max) {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+bool cli_parse_double(const char *text, double *value) {
+    if (text[0] == '\0' || isspace((unsigned char)text[0])) {
+        return false;
+    }
+    char *end;
+    double parsed = strtod(text, &end);
+    if (*end != '\0' || !isfinite(parsed)) {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+bool cli_parse_counts_per_mgdl(const char *text, float *value) {
+    double parsed;
+    if (!cli_parse_double(text, &parsed) || !(parsed > 0.0) || parsed > FLT_MAX || (float)parsed == 0.0f) {
+        return false;
+    }
+    *value = (float)parsed;
+    return true;
+}
+
+bool cli_parse_filter_type(const char *text, glucose_filter_type_t *type) {
+    if (strcmp(text, "none") == 0) {
+        *type = FILTER_TYPE_NONE;
+    } else if (strcmp(text, "average") == 0) {
+        *type = FILTER_TYPE_MOVING_AVERAGE;
+    } else if (strcmp(text, "median") == 0) {
+        *type = FILTER_TYPE_MEDIAN;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,181 @@
+#include "i2c_sim.h"
+#include "ads1115.h"
+#include "profile.h"
+#include "sim_clock.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#define ADS1115_CONFIG_RESET_VALUE 0x8583 // Power-on default from the datasheet
+#define ADS1115_DR_MASK            ((uint16_t)0x07 << 5)
+#define I2C_BITS_PER_BYTE          9      // 8 data bits + ACK
+#define I2C_DEFAULT_FREQUENCY      100000
+
+static uint8_t reg_pointer;
+static uint16_t config_reg;
+static uint16_t conversion_reg;
+static int16_t next_conversion_value;
+static bool converting;
+static uint64_t conversion_done_us; // Virtual time at which the running conversion completes
+static uint32_t bus_frequency = I2C_DEFAULT_FREQUENCY;
+static uint32_t failing_transfers; // Remaining transfers to NACK, for error-path tests
+static i2c_sim_stats_t stats;
+
+// Nominal conversion time (1 / data rate), rounded up
+static uint32_t conversion_time_us(uint16_t config) {
+    static const uint32_t sps[] = { 8, 16, 32, 64, 128, 250, 475, 860 };
+    uint32_t rate = sps[(config & ADS1115_DR_MASK) >> 5];
+    return (1000000 + rate - 1) / rate;
+}
+
+// Start/stop overhead is folded into the address byte
+static void bus_transfer(uint8_t len) {
+    stats.transfers++;
+    sim_clock_advance_us(((uint64_t)(len + 1) * I2C_BITS_PER_BYTE * 1000000) / bus_frequency);
+}
+
+static void start_conversion(void) {
+    uint32_t time_us = conversion_time_us(config_reg);
+    stats.conversions++;
+    stats.adc_active_us += time_us;
+    converting = true;
+    conversion_done_us = sim_clock_now_us() + time_us;
+    config_reg &= ~((uint16_t)ADS1115_CONFIG_OS_SINGLE_START); // OS reads 0 while busy
+}
+
+static uint16_t read_current_register(void) {
+    switch (reg_pointer) {
+        case ADS1115_REG_POINTER_CONVERSION:
+            return conversion_reg;
+        case ADS1115_REG_POINTER_CONFIG:
+            if (converting && sim_clock_now_us() >= conversion_done_us) {
+                converting = false;
+                conversion_reg = (uint16_t)next_conversion_value;
+                config_reg |= ADS1115_CONFIG_OS_SINGLE_START;
+            }
+            return config_reg;
+        default:
+            return 0; // Threshold registers are not used by the firmware
+    }
+}
+
+void i2c_sim_reset(void) {
+    reg_pointer = ADS1115_REG_POINTER_CONVERSION;
+    config_reg = ADS1115_CONFIG_RESET_VALUE;
+    conversion_reg = 0;
+    next_conversion_value = 0;
+    converting = false;
+    conversion_done_us = 0;
+    failing_transfers = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+void i2c_sim_set_conversion_value(int16_t value) {
+    next_conversion_value = value;
+}
+
+void i2c_sim_fail_next_transfers(uint32_t count) {
+    failing_transfers = count;
+}
+
+// Consumes one injected failure: only the address byte goes out and is not acknowledged
+static bool address_nacked(void) {
+    if (failing_transfers == 0) {
+        return false;
+    }
+    failing_transfers--;
+    bus_transfer(0);
+    return true;
+}
+
+void i2c_sim_get_stats(i2c_sim_stats_t *out) {
+    if (out != NULL) {
+        *out = stats;
+    }
+}
+
+void i2c_sim_clear_stats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+i2c_ret_code_t i2c_init(uint32_t sda_pin, uint32_t scl_pin, uint32_t frequency)
+{
+    (void)sda_pin;
+    (void)scl_pin;
+    bus_frequency = (frequency != 0) ? frequency : I2C_DEFAULT_FREQUENCY;
+    i2c_sim_reset();
+    return I2C_SUCCESS;
+}
+
+static i2c_ret_code_t sim_write(const uint8_t *data, uint8_t len)
+{
+    if (data == NULL || len == 0) {
+        return I2C_ERROR_INVALID_PARAM;
+    }
+    if (address_nacked()) {
+        return I2C_ERROR_NACK;
+    }
+    bus_transfer(len);
+    stats.bytes_written += len;
+
+    reg_pointer = data[0] & 0x03;
+    if (len < 3) {
+        return I2C_SUCCESS; // Pointer-only write
+    }
+
+    uint16_t value = ((uint16_t)data[1] << 8) | data[2];
+    switch (reg_pointer) {
+        case ADS1115_REG_POINTER_CONFIG:
+            // OS only acts as a start trigger on write; it is ignored while a conversion is pending
+            config_reg = (value & ~((uint16_t)ADS1115_CONFIG_OS_SINGLE_START)) |
+                         (config_reg & ADS1115_CONFIG_OS_SINGLE_START);
+            if ((value & ADS1115_CONFIG_OS_SINGLE_START) && !converting &&
+                (value & ADS1115_CONFIG_MODE_SINGLE)) {
+                start_conversion();
+            }
+            break;
+        case ADS1115_REG_POINTER_CONVERSION:
+            return I2C_ERROR_NACK; // Read-only register
+        default:
+            break;
+    }
+    return I2C_SUCCESS;
+}
+
+static i2c_ret_code_t sim_read(uint8_t *data, uint8_t len)
+{
+    if (data == NULL || len == 0) {
+        return I2C_ERROR_INVALID_PARAM;
+    }
+    if (address_nacked()) {
+        return I2C_ERROR_NACK;
+    }
+    bus_transfer(len);
+    stats.bytes_read += len;
+
+    uint16_t value = read_current_register();
+    for (uint8_t i = 0; i < len; i++) {
+        data[i] = (i % 2 == 0) ? (uint8_t)(value >> 8) : (uint8_t)(value & 0xFF);
+    }
+    return I2C_SUCCESS;
+}
+
+// The profiling probes wrap the whole emulated transfer, as they do in drivers/src/i2c.c
+i2c_ret_code_t i2c_write(uint8_t address, const uint8_t *data, uint8_t len, bool no_stop)
+{
+    (void)address;
+    (void)no_stop;
+    PROFILE_BEGIN(PROFILE_PROBE_I2C_WRITE);
+    i2c_ret_code_t err_code = sim_write(data, len);
+    PROFILE_END(PROFILE_PROBE_I2C_WRITE);
+    return err_code;
+}
+
+i2c_ret_code_t i2c_read(uint8_t address, uint8_t *data, uint8_t len)
+{
+    (void)address;
+    PROFILE_BEGIN(PROFILE_PROBE_I2C_READ);
+    i2c_ret_code_t err_code = sim_read(data, len);
+    PROFILE_END(PROFILE_PROBE_I2C_READ);
+    return err_code;
+}
@@ -0,0 +1,25 @@
+#include "sim_clock.h"
+
+static uint64_t now_us = 0;
+
+void sim_clock_reset(void) {
+    now_us = 0;
+}
+
+uint64_t sim_clock_now_us(void) {
+    return now_us;
+}
+
+void sim_clock_advance_us(uint64_t us) {
+    now_us += us;
+}
+
+void sim_clock_advance_to_us(uint64_t us) {
+    if (us > now_us) {
+        now_us = us;
+    }
+}
+
+void sim_clock_delay_ms(uint32_t ms) {
+    now_us += (uint64_t)ms * 1000;
+}
@@ -0,0 +1,145 @@
+#include "trace.h"
+#include "glucose_filter.h"
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_LINE_MAX 128
+
+uint32_t trace_read_le32(const uint8_t *bytes) {
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+trace_ret_code_t trace_decode_record(const uint8_t *record, trace_sample_t *sample) {
+    sample->timestamp_s = trace_read_le32(&record[0]);
+    sample->raw_code = (int16_t)((uint16_t)record[4] | ((uint16_t)record[5] << 8));
+    sample->window_size = record[6];
+    return (sample->window_size <= MAX_FILTER_WINDOW_SIZE) ? TRACE_OK : TRACE_ERR_FORMAT;
+}
+
+trace_ret_code_t trace_open(trace_reader_t *reader, const char *path) {
+    if (reader == NULL || path == NULL) {
+        return TRACE_ERR_OPEN;
+    }
+    memset(reader, 0, sizeof(*reader));
+
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL) {
+        return TRACE_ERR_OPEN;
+    }
+
+    uint8_t header[TRACE_HEADER_SIZE];
+    size_t n = fread(header, 1, sizeof(header), reader->file);
+    if (n == sizeof(header) && memcmp(header, TRACE_BINARY_MAGIC, 4) == 0) {
+        if (trace_read_le32(&header[4]) != TRACE_BINARY_VERSION) {
+            trace_close(reader);
+            return TRACE_ERR_FORMAT;
+        }
+        reader->binary = true;
+        return TRACE_OK;
+    }
+
+    // Not a binary trace: parse as CSV from the beginning
+    rewind(reader->file);
+    return TRACE_OK;
+}
+
+static trace_ret_code_t next_binary(trace_reader_t *reader, trace_sample_t *sample) {
+    uint8_t record[TRACE_RECORD_SIZE];
+    size_t n = fread(record, 1, sizeof(record), reader->file);
+    if (n == 0 && feof(reader->file)) {
+        return TRACE_END;
+    }
+    reader->line++;
+    if (n != sizeof(record)) {
+        return TRACE_ERR_FORMAT; // Truncated record
+    }
+    return trace_decode_record(record, sample);
+}
+
+static trace_ret_code_t next_csv(trace_reader_t *reader, trace_sample_t *sample) {
+    char line[TRACE_LINE_MAX];
+    while (fgets(line, sizeof(line), reader->file) != NULL) {
+        reader->line++;
+
+        char *p = line;
+        while (isspace((unsigned char)*p)) {
+            p++;
+        }
+        if (*p == '\0' || *p == '#') {
+            continue;
+        }
+        if (!isdigit((unsigned char)*p)) {
+            if (reader->line == 1) {
+                continue; // Column header
+            }
+            return TRACE_ERR_FORMAT;
+        }
+
+        char *end;
+        errno = 0;
+        unsigned long timestamp = strtoul(p, &end, 10);
+        if (errno != 0 || end == p || timestamp > UINT32_MAX) {
+            return TRACE_ERR_FORMAT;
+        }
+        p = end;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p++ != ',') {
+            return TRACE_ERR_FORMAT;
+        }
+        long raw = strtol(p, &end, 10);
+        if (errno != 0 || end == p || raw < INT16_MIN || raw > INT16_MAX) {
+            return TRACE_ERR_FORMAT;
+        }
+        p = end;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        unsigned long window = 0;
+        if (*p == ',') {
+            p++;
+            window = strtoul(p, &end, 10);
+            if (errno != 0 || end == p || window > MAX_FILTER_WINDOW_SIZE) {
+                return TRACE_ERR_FORMAT;
+            }
+        }
+        while (isspace((unsigned char)*end)) {
+            end++;
+        }
+        if (*end != '\0') {
+            return TRACE_ERR_FORMAT;
+        }
+
+        sample->timestamp_s = (uint32_t)timestamp;
+        sample->raw_code = (int16_t)raw;
+        sample->window_size = (uint8_t)window;
+        return TRACE_OK;
+    }
+    return ferror(reader->file) ? TRACE_ERR_FORMAT : TRACE_END;
+}
+
+trace_ret_code_t trace_next(trace_reader_t *reader, trace_sample_t *sample) {
+    if (reader == NULL || reader->file == NULL || sample == NULL) {
+        return TRACE_ERR_FORMAT;
+    }
+    trace_ret_code_t err_code = reader->binary ? next_binary(reader, sample) : next_csv(reader, sample);
+    if (err_code != TRACE_OK) {
+        return err_code;
+    }
+    if (reader->has_sample && sample->timestamp_s < reader->last_timestamp_s) {
+        return TRACE_ERR_FORMAT; // Time going backwards
+    }
+    reader->last_timestamp_s = sample->timestamp_s;
+    reader->has_sample = true;
+    return TRACE_OK;
+}
+
+void trace_close(trace_reader_t *reader) {
+    if (reader != NULL && reader->file != NULL) {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+}
@@ -0,0 +1,145 @@
+// Behaviour tests for the glucose filter, in particular window resizing.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "glucose_filter.h"
+
+static int failures = 0;
+
+#define CHECK_FLOAT(actual, expected)                                                   \
+    do {                                                                                \
+        float actual_value = (actual);                                                  \
+        float expected_value = (expected);                                              \
+        if (actual_value != expected_value) {                                           \
+            fprintf(stderr, "%s:%d: %s = %g, expected %g\n", __FILE__, __LINE__, #actual, \
+                    (double)actual_value, (double)expected_value);                      \
+            failures++;                                                                 \
+        }                                                                               \
+    } while (0)
+
+static void init_filter(glucose_filter_type_t type, uint8_t window_size) {
+    glucose_filter_params_t params = { type, window_size };
+    glucose_filter_init(&params);
+}
+
+// Until the first window is full the filter passes raw values through
+static void test_startup_passes_raw(void) {
+    init_filter(FILTER_TYPE_MOVING_AVERAGE, 4);
+    CHECK_FLOAT(glucose_filter_apply(100.0f), 100.0f);
+    CHECK_FLOAT(glucose_filter_apply(110.0f), 110.0f);
+    CHECK_FLOAT(glucose_filter_apply(120.0f), 120.0f);
+    CHECK_FLOAT(glucose_filter_apply(130.0f), 115.0f);
+}
+
+// Growing the window keeps filtering over the held samples instead of passing raw through
+static void test_grow_keeps_filtering(void) {
+    init_filter(FILTER_TYPE_MOVING_AVERAGE, 4);
+    glucose_filter_apply(100.0f);
+    glucose_filter_apply(110.0f);
+    glucose_filter_apply(100.0f);
+    CHECK_FLOAT(glucose_filter_apply(110.0f), 105.0f);
+
+    glucose_filter_resize_window(8);
+    CHECK_FLOAT(glucose_filter_apply(100.0f), 104.0f);  // 5 held samples
+    CHECK_FLOAT(glucose_filter_apply(110.0f), 105.0f);  // 6
+    CHECK_FLOAT(glucose_filter_apply(100.0f), 730.0f / 7.0f);  // 7
+    CHECK_FLOAT(glucose_filter_apply(110.0f), 105.0f);  // 8: window full
+    // The window now slides: the oldest sample (100) is replaced by 130
+    CHECK_FLOAT(glucose_filter_apply(130.0f), 108.75f);
+}
+
+// Shrinking the window keeps only the newest samples
+static void test_shrink_keeps_newest(void) {
+    init_filter(FILTER_TYPE_MEDIAN, 5);
+    glucose_filter_apply(10.0f);
+    glucose_filter_apply(20.0f);
+    glucose_filter_apply(30.0f);
+    glucose_filter_apply(40.0f);
+    CHECK_FLOAT(glucose_filter_apply(50.0f), 30.0f);
+
+    glucose_filter_resize_window(3);  // Keeps 30, 40, 50
+    CHECK_FLOAT(glucose_filter_apply(0.0f), 40.0f);   // 0, 40, 50
+    CHECK_FLOAT(glucose_filter_apply(0.0f), 0.0f);    // 50, 0, 0
+}
+
+// Resizing during startup does not skip the initial fill
+static void test_resize_before_primed(void) {
+    init_filter(FILTER_TYPE_MOVING_AVERAGE, 4);
+    glucose_filter_apply(100.0f);
+    glucose_filter_resize_window(2);
+    CHECK_FLOAT(glucose_filter_apply(120.0f), 110.0f);
+
+    init_filter(FILTER_TYPE_MOVING_AVERAGE, 2);
+    glucose_filter_apply(100.0f);
+    glucose_filter_resize_window(4);
+    CHECK_FLOAT(glucose_filter_apply(120.0f), 120.0f);
+}
+
+// set_params clears the history, so the filter primes again
+static void test_set_params_resets(void) {
+    init_filter(FILTER_TYPE_MOVING_AVERAGE, 2);
+    glucose_filter_apply(100.0f);
+    glucose_filter_apply(120.0f);
+
+    glucose_filter_params_t params = { FILTER_TYPE_MOVING_AVERAGE, 3 };
+    glucose_filter_set_params(&params);
+    CHECK_FLOAT(glucose_filter_apply(90.0f), 90.0f);
+}
+
+// Interleaved private contexts give the same bits as separate runs of the global API,
+// which is what glucose_batch relies on when it filters streams side by side
+static void test_contexts_match_global_api(void) {
+    enum { SAMPLES = 200 };
+    static const glucose_filter_params_t params[2] = {
+        { FILTER_TYPE_MOVING_AVERAGE, 7 },
+        { FILTER_TYPE_MEDIAN, 4 },
+    };
+    float input[2][SAMPLES];
+    float expected[2][SAMPLES];
+    for (int i = 0; i < SAMPLES; i++) {
+        input[0][i] = 100.0f + (float)((i * 37) % 23) * 0.7f;
+        input[1][i] = 80.0f - (float)((i * 11) % 17) * 1.3f;
+    }
+
+    for (int s = 0; s < 2; s++) {
+        glucose_filter_init(&params[s]);
+        for (int i = 0; i < SAMPLES; i++) {
+            expected[s][i] = glucose_filter_apply(input[s][i]);
+        }
+    }
+
+    glucose_filter_ctx_t ctx[2];
+    glucose_filter_ctx_init(&ctx[0], &params[0]);
+    glucose_filter_ctx_init(&ctx[1], &params[1]);
+    int mismatches = 0;
+    for (int i = 0; i < SAMPLES; i++) {
+        for (int s = 0; s < 2; s++) {
+            float actual = glucose_filter_ctx_apply(&ctx[s], input[s][i]);
+            if (memcmp(&actual, &expected[s][i], sizeof(float)) != 0) {
+                mismatches++;
+            }
+        }
+    }
+    if (mismatches > 0) {
+        fprintf(stderr, "%s:%d: %d interleaved context output(s) differ from the global API\n", __FILE__,
+                __LINE__, mismatches);
+        failures++;
+    }
+}
+
+int main(void) {
+    test_startup_passes_raw();
+    test_grow_keeps_filtering();
+    test_shrink_keeps_newest();
+    test_resize_before_primed();
+    test_set_params_resets();
+    test_contexts_match_global_api();
+
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("glucose_filter_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,38 @@
+# End-to-end check that glucose_batch reproduces trace_replay bit for bit.
+# Run by ctest as:
+#   cmake -DMAKE_TRACE=... -DTRACE_REPLAY=... -DGLUCOSE_BATCH=... -DWORK_DIR=... -P golden_roundtrip.cmake
+
+# Runs a command in WORK_DIR and fails the test unless it exits with expected_result
+function(run_step expected_result)
+    execute_process(COMMAND ${ARGN} WORKING_DIRECTORY ${WORK_DIR}
+                    RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE output)
+    if(NOT result EQUAL expected_result)
+        string(REPLACE ";" " " command "${ARGN}")
+        message(FATAL_ERROR "${command}\nexited with ${result}, expected ${expected_result}:\n${output}")
+    endif()
+endfunction()
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR}/traces/unit ${WORK_DIR}/golden/traces/unit)
+
+run_step(0 ${MAKE_TRACE} traces/unit/stream.bin 5000)
+
+# glucose_batch looks the golden file up at golden/<trace path without extension>.csv
+foreach(filter average median)
+    run_step(0 ${TRACE_REPLAY} --filter ${filter} --window 7 --output golden/traces/unit/stream.csv
+             traces/unit/stream.bin)
+    run_step(0 ${GLUCOSE_BATCH} --threads 2 --filter ${filter} --window 7 --golden-dir golden
+             traces/unit/stream.bin)
+endforeach()
+
+# A unit running the sampling controller: both tools must follow the recorded windows
+run_step(0 ${MAKE_TRACE} traces/unit/adaptive.bin 5000 --windows)
+run_step(0 ${TRACE_REPLAY} --output golden/traces/unit/adaptive.csv traces/unit/adaptive.bin)
+run_step(0 ${GLUCOSE_BATCH} --golden-dir golden traces/unit/adaptive.bin)
+# The same readings without recorded windows must not match that output
+configure_file(${WORK_DIR}/traces/unit/stream.bin ${WORK_DIR}/traces/unit/fixed.bin COPYONLY)
+configure_file(${WORK_DIR}/golden/traces/unit/adaptive.csv ${WORK_DIR}/golden/traces/unit/fixed.csv COPYONLY)
+run_step(1 ${GLUCOSE_BATCH} --golden-dir golden traces/unit/fixed.bin)
+
+# The comparison must be able to fail: another window cannot match the median golden file
+run_step(1 ${GLUCOSE_BATCH} --filter median --window 3 --golden-dir golden traces/unit/stream.bin)
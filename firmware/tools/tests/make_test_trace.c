@@ -0,0 +1,65 @@
+// Writes a synthetic binary trace (see tools/sim/inc/trace.h) for the end-to-end tests:
+// a slow glucose swing around zero ADC counts with deterministic pseudo-random noise.
+// With --windows the records also carry a filter window that cycles through the
+// sampling controller's default levels, as logged by a unit running it.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cli.h"
+#include "trace.h"
+
+#define TEST_TRACE_INTERVAL_S 60
+#define TEST_LEVEL_SAMPLES    300 // Samples between two window changes
+
+static void write_le32(uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+int main(int argc, char **argv) {
+    static const uint8_t windows[] = { 5, 10, 2, 5 }; // Normal, high dynamics, low power, normal
+    unsigned long samples;
+    bool record_windows = (argc == 4 && strcmp(argv[3], "--windows") == 0);
+    if ((argc != 3 && !record_windows) || !cli_parse_ulong(argv[2], 1, 10000000, &samples)) {
+        fprintf(stderr, "usage: %s <trace.bin> <samples> [--windows]\n", argv[0]);
+        return 2;
+    }
+    FILE *file = fopen(argv[1], "wb");
+    if (file == NULL) {
+        fprintf(stderr, "%s: cannot open\n", argv[1]);
+        return 1;
+    }
+
+    uint8_t header[TRACE_HEADER_SIZE];
+    memcpy(header, TRACE_BINARY_MAGIC, 4);
+    write_le32(&header[4], TRACE_BINARY_VERSION);
+    int ok = fwrite(header, sizeof(header), 1, file) == 1;
+
+    uint32_t rng = 12345;
+    int32_t level = 0;
+    for (unsigned long i = 0; i < samples && ok; i++) {
+        rng = rng * 1664525u + 1013904223u; // Numerical Recipes LCG
+        level += (i % 400 < 200) ? 7 : -7;  // Triangle swing through negative codes
+        int16_t raw_code = (int16_t)(level + (int32_t)(rng >> 24) - 128);
+
+        uint8_t record[TRACE_RECORD_SIZE] = { 0 };
+        write_le32(&record[0], (uint32_t)(i * TEST_TRACE_INTERVAL_S));
+        record[4] = (uint8_t)((uint16_t)raw_code & 0xFF);
+        record[5] = (uint8_t)((uint16_t)raw_code >> 8);
+        if (record_windows) {
+            record[6] = windows[(i / TEST_LEVEL_SAMPLES) % (sizeof(windows) / sizeof(windows[0]))];
+        }
+        ok = fwrite(record, sizeof(record), 1, file) == 1;
+    }
+    if (fclose(file) != 0 || !ok) {
+        fprintf(stderr, "%s: write failed\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
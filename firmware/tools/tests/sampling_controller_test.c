@@ -0,0 +1,207 @@
+// Behaviour tests for the adaptive sampling controller, run against the simulated ADS1115.
+
+#include <stdio.h>
+
+#include "ads1115.h"
+#include "glucose_filter.h"
+#include "i2c_sim.h"
+#include "sampling_controller.h"
+#include "sim_clock.h"
+
+#define TEST_I2C_ADDRESS ADS1115_ADDRESS_GND
+#define DR_MASK          ((uint16_t)0x07 << 5)
+
+static int failures = 0;
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                         \
+        }                                                                       \
+    } while (0)
+
+// Brings the ADC, filter and controller up at the normal level, as the firmware does at boot
+static void setup(void) {
+    sim_clock_reset();
+    ads1115_set_delay_function(sim_clock_delay_ms);
+    i2c_init(0, 0, 400000);
+    CHECK(ads1115_init(TEST_I2C_ADDRESS, ADS1115_PGA_4_096V, ADS1115_DR_128SPS, ADS1115_MUX_P0_NG) == ADS1115_OK);
+    glucose_filter_init(NULL);
+    sampling_controller_init(NULL);
+}
+
+static uint16_t adc_data_rate(void) {
+    uint8_t pointer = ADS1115_REG_POINTER_CONFIG;
+    uint8_t data[2] = { 0, 0 };
+    CHECK(i2c_write(TEST_I2C_ADDRESS, &pointer, 1, false) == I2C_SUCCESS);
+    CHECK(i2c_read(TEST_I2C_ADDRESS, data, 2) == I2C_SUCCESS);
+    return (uint16_t)(((uint16_t)data[0] << 8) | data[1]) & DR_MASK;
+}
+
+static uint8_t filter_window(void) {
+    glucose_filter_params_t params;
+    glucose_filter_get_params(&params);
+    return params.window_size;
+}
+
+// Updates the controller with a noise-free reading and applies any level change
+static bool feed(float glucose) {
+    bool changed = sampling_controller_update(glucose, glucose);
+    if (changed) {
+        CHECK(sampling_controller_apply(TEST_I2C_ADDRESS) == ADS1115_OK);
+    }
+    return changed;
+}
+
+// Feeds readings with no change and no noise until the given level is reached
+static void settle_to(sampling_level_t level) {
+    for (int i = 0; i < 50 && sampling_controller_get_level() != level; i++) {
+        feed(100.0f);
+    }
+    CHECK(sampling_controller_get_level() == level);
+}
+
+// Crossing the rate or the noise up threshold steps up on that reading
+static void test_step_up_immediately(void) {
+    setup();
+    CHECK(!feed(100.0f));
+    CHECK(feed(103.0f)); // 3 mg/dL/min at the 1 min normal interval
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_HIGH_DYNAMICS);
+
+    setup();
+    // No rate of change, but |raw - filtered| = 30 lifts the noise estimate to 7.5
+    CHECK(sampling_controller_update(130.0f, 100.0f));
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_HIGH_DYNAMICS);
+
+    // Only one level per reading
+    setup();
+    settle_to(SAMPLING_LEVEL_LOW_POWER);
+    CHECK(feed(110.0f)); // 10 mg/dL over the 2.5 min low power interval
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_NORMAL);
+}
+
+// Between the down and up thresholds the level holds and the calm count restarts
+static void test_hold_inside_band(void) {
+    setup();
+    for (int i = 0; i < 4; i++) {
+        CHECK(!feed(100.0f));
+    }
+    CHECK(!feed(101.5f)); // 1.5 mg/dL/min: above rate_down_threshold, below rate_up_threshold
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_NORMAL);
+
+    // Without the reset the fifth calm reading in total would already step down
+    for (int i = 0; i < 4; i++) {
+        CHECK(!feed(101.5f));
+    }
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_NORMAL);
+    CHECK(feed(101.5f));
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_LOW_POWER);
+
+    // Noise inside its band holds the level too: 16 -> noise estimate 4
+    setup();
+    CHECK(!sampling_controller_update(116.0f, 100.0f));
+    for (int i = 0; i < 4; i++) {
+        CHECK(!feed(100.0f));
+    }
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_NORMAL);
+}
+
+// Stepping down takes calm_readings_to_step_down calm readings in a row, per level
+static void test_step_down_after_calm_readings(void) {
+    sampling_controller_params_t params;
+    sampling_controller_get_default_params(&params);
+
+    setup();
+    CHECK(!feed(103.0f)); // First reading has no rate
+    CHECK(feed(106.0f));
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_HIGH_DYNAMICS);
+
+    for (uint8_t i = 1; i < params.calm_readings_to_step_down; i++) {
+        CHECK(!feed(106.0f));
+    }
+    CHECK(feed(106.0f));
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_NORMAL);
+
+    // The count starts over at the new level
+    for (uint8_t i = 1; i < params.calm_readings_to_step_down; i++) {
+        CHECK(!feed(106.0f));
+    }
+    CHECK(feed(106.0f));
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_LOW_POWER);
+}
+
+// The level saturates at both ends
+static void test_clamped_at_extremes(void) {
+    setup();
+    settle_to(SAMPLING_LEVEL_LOW_POWER);
+    for (int i = 0; i < 20; i++) {
+        CHECK(!feed(100.0f));
+    }
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_LOW_POWER);
+
+    setup();
+    float glucose = 100.0f;
+    feed(glucose);
+    for (int i = 0; i < 5; i++) {
+        glucose += 10.0f;
+        feed(glucose);
+    }
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_HIGH_DYNAMICS);
+    CHECK(!feed(glucose + 10.0f));
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_HIGH_DYNAMICS);
+}
+
+// Default filter span of 5 min: 2, 5 and 10 readings at 150 s, 60 s and 30 s
+static void test_filter_window_per_level(void) {
+    setup();
+    CHECK(sampling_controller_get_filter_window() == 5);
+
+    settle_to(SAMPLING_LEVEL_LOW_POWER);
+    CHECK(sampling_controller_get_filter_window() == 2);
+    CHECK(filter_window() == 2);
+
+    CHECK(feed(200.0f));
+    CHECK(feed(300.0f));
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_HIGH_DYNAMICS);
+    CHECK(sampling_controller_get_filter_window() == 10);
+    CHECK(filter_window() == 10);
+}
+
+// A failed apply still resizes the window and is retried on the next update
+static void test_failed_apply_is_retried(void) {
+    setup();
+    CHECK(!sampling_controller_update(100.0f, 100.0f));
+    CHECK(sampling_controller_update(105.0f, 105.0f)); // 5 mg/dL/min: step up
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_HIGH_DYNAMICS);
+
+    i2c_sim_fail_next_transfers(1);
+    CHECK(sampling_controller_apply(TEST_I2C_ADDRESS) != ADS1115_OK);
+    CHECK(filter_window() == 10);
+    CHECK(adc_data_rate() == ADS1115_DR_128SPS);
+
+    // Same level, but the data rate is still pending
+    CHECK(sampling_controller_update(105.0f, 105.0f));
+    CHECK(sampling_controller_get_level() == SAMPLING_LEVEL_HIGH_DYNAMICS);
+    CHECK(sampling_controller_apply(TEST_I2C_ADDRESS) == ADS1115_OK);
+    CHECK(adc_data_rate() == ADS1115_DR_475SPS);
+    CHECK(filter_window() == 10);
+
+    CHECK(!sampling_controller_update(105.0f, 105.0f));
+}
+
+int main(void) {
+    test_step_up_immediately();
+    test_hold_inside_band();
+    test_step_down_after_calm_readings();
+    test_clamped_at_extremes();
+    test_filter_window_per_level();
+    test_failed_apply_is_retried();
+
+    if (failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("sampling_controller_test: all checks passed\n");
+    return 0;
+}
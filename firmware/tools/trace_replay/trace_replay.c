@@ -0,0 +1,380 @@
+// Replays recorded sensor traces through the real acquisition path
+// (ads1115_read_raw_data() -> glucose_filter_apply()) on top of the simulated
+// I2C bus and a virtual clock, as fast as the host allows.
+//
+// Emits the filtered output as CSV, reports per-stage latency (host CPU time
+// and simulated device time) and throughput, and optionally diffs the output
+// against a golden file produced by an earlier run. Built with
+// GLUCOSE_PROFILING=ON it also dumps the firmware's profiling probe table.
+
+#define _POSIX_C_SOURCE 199309L // clock_gettime()
+
+#include <limits.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ads1115.h"
+#include "cli.h"
+#include "glucose_filter.h"
+#include "i2c_sim.h"
+#include "profile.h"
+#include "sim_clock.h"
+#include "trace.h"
+
+#define REPLAY_I2C_ADDRESS     ADS1115_ADDRESS_GND
+#define REPLAY_I2C_FREQUENCY   400000
+#define MAX_REPORTED_MISMATCHES 10
+
+typedef struct {
+    const char *trace_path;
+    const char *output_path;  // NULL: no output, "-": stdout
+    const char *golden_path;
+    double tolerance;
+    float counts_per_mgdl;
+    ads1115_sampling_rate_t data_rate;
+    glucose_filter_params_t filter;
+} replay_options_t;
+
+typedef struct {
+    uint64_t min;
+    uint64_t max;
+    uint64_t sum;
+    uint64_t count;
+} stage_stats_t;
+
+typedef struct {
+    FILE *file;
+    uint32_t line;
+    uint64_t compared;
+    uint64_t mismatches;
+    double max_diff;
+    bool length_mismatch;
+} golden_t;
+
+static uint64_t host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#if PROFILE_ENABLED
+static int print_stderr(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int written = vfprintf(stderr, format, args);
+    va_end(args);
+    return written;
+}
+#endif
+
+static void stage_record(stage_stats_t *stage, uint64_t value) {
+    if (stage->count == 0 || value < stage->min) {
+        stage->min = value;
+    }
+    if (value > stage->max) {
+        stage->max = value;
+    }
+    stage->sum += value;
+    stage->count++;
+}
+
+static double stage_mean(const stage_stats_t *stage) {
+    return (stage->count > 0) ? (double)stage->sum / stage->count : 0.0;
+}
+
+// Reads the next "timestamp_s,raw_code,filtered" line of the golden file
+static bool golden_next(golden_t *golden, uint32_t *timestamp_s, int *raw_code, double *filtered) {
+    char line[128];
+    while (fgets(line, sizeof(line), golden->file) != NULL) {
+        golden->line++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+        unsigned int ts;
+        if (sscanf(line, "%u,%d,%lf", &ts, raw_code, filtered) == 3) {
+            *timestamp_s = ts;
+            return true;
+        }
+        if (golden->line != 1) {
+            fprintf(stderr, "golden:%u: malformed line\n", golden->line);
+        }
+    }
+    return false;
+}
+
+static void golden_compare(golden_t *golden, const trace_sample_t *sample, float filtered, double tolerance) {
+    uint32_t golden_ts;
+    int golden_raw;
+    double golden_filtered;
+    if (!golden_next(golden, &golden_ts, &golden_raw, &golden_filtered)) {
+        golden->length_mismatch = true;
+        return;
+    }
+    golden->compared++;
+
+    // Golden values are printed with 9 significant digits, which round-trips a float exactly
+    double diff = fabs((double)filtered - (double)(float)golden_filtered);
+    if (golden_ts != sample->timestamp_s || golden_raw != sample->raw_code || !(diff <= tolerance)) {
+        if (golden->mismatches < MAX_REPORTED_MISMATCHES) {
+            fprintf(stderr, "golden:%u: expected %u,%d,%.9g got %u,%d,%.9g\n", golden->line,
+                    golden_ts, golden_raw, golden_filtered, sample->timestamp_s, sample->raw_code, (double)filtered);
+        }
+        golden->mismatches++;
+    }
+    if (diff > golden->max_diff) {
+        golden->max_diff = diff;
+    }
+}
+
+static bool parse_data_rate(const char *text, ads1115_sampling_rate_t *rate) {
+    static const struct {
+        unsigned long sps;
+        ads1115_sampling_rate_t rate;
+    } rates[] = {
+        { 8, ADS1115_DR_8SPS },     { 16, ADS1115_DR_16SPS },   { 32, ADS1115_DR_32SPS },
+        { 64, ADS1115_DR_64SPS },   { 128, ADS1115_DR_128SPS }, { 250, ADS1115_DR_250SPS },
+        { 475, ADS1115_DR_475SPS }, { 860, ADS1115_DR_860SPS },
+    };
+    unsigned long sps;
+    if (!cli_parse_ulong(text, 1, ULONG_MAX, &sps)) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        if (rates[i].sps == sps) {
+            *rate = rates[i].rate;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void print_usage(const char *program) {
+    fprintf(stderr,
+            "usage: %s [options] <trace>\n"
+            "  --output FILE           write timestamp_s,raw_code,filtered CSV ('-' for stdout)\n"
+            "  --golden FILE           diff the filtered output against FILE, exit 1 on mismatch\n"
+            "  --tolerance X           allowed |filtered - golden| (default 0: exact)\n"
+            "  --filter none|average|median   filter type (default average)\n"
+            "  --window N              filter window, 1..%d (default 5); windows recorded\n"
+            "                          in the trace take over from the sample they appear on\n"
+            "  --data-rate SPS         ADS1115 data rate (default 128)\n"
+            "  --counts-per-mgdl X     ADC counts per mg/dL fed to the filter (default 50)\n",
+            program, MAX_FILTER_WINDOW_SIZE);
+}
+
+static bool parse_args(int argc, char **argv, replay_options_t *options) {
+    memset(options, 0, sizeof(*options));
+    options->counts_per_mgdl = 50.0f;
+    options->data_rate = ADS1115_DR_128SPS;
+    options->filter.type = FILTER_TYPE_MOVING_AVERAGE;
+    options->filter.window_size = 5;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (arg[0] != '-' || strcmp(arg, "-") == 0) {
+            if (options->trace_path != NULL) {
+                return false;
+            }
+            options->trace_path = arg;
+            continue;
+        }
+        if (value == NULL) {
+            return false;
+        }
+        i++;
+        if (strcmp(arg, "--output") == 0) {
+            options->output_path = value;
+        } else if (strcmp(arg, "--golden") == 0) {
+            options->golden_path = value;
+        } else if (strcmp(arg, "--tolerance") == 0) {
+            if (!cli_parse_double(value, &options->tolerance) || options->tolerance < 0.0) {
+                return false;
+            }
+        } else if (strcmp(arg, "--filter") == 0) {
+            if (!cli_parse_filter_type(value, &options->filter.type)) {
+                return false;
+            }
+        } else if (strcmp(arg, "--window") == 0) {
+            unsigned long window;
+            if (!cli_parse_ulong(value, 1, MAX_FILTER_WINDOW_SIZE, &window)) {
+                return false;
+            }
+            options->filter.window_size = (uint8_t)window;
+        } else if (strcmp(arg, "--data-rate") == 0) {
+            if (!parse_data_rate(value, &options->data_rate)) {
+                return false;
+            }
+        } else if (strcmp(arg, "--counts-per-mgdl") == 0) {
+            if (!cli_parse_counts_per_mgdl(value, &options->counts_per_mgdl)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return options->trace_path != NULL;
+}
+
+int main(int argc, char **argv) {
+    replay_options_t options;
+    if (!parse_args(argc, argv, &options)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    trace_reader_t trace;
+    trace_ret_code_t trace_err = trace_open(&trace, options.trace_path);
+    if (trace_err != TRACE_OK) {
+        fprintf(stderr, "%s: cannot open trace\n", options.trace_path);
+        return 2;
+    }
+
+    FILE *output = NULL;
+    if (options.output_path != NULL) {
+        output = (strcmp(options.output_path, "-") == 0) ? stdout : fopen(options.output_path, "w");
+        if (output == NULL) {
+            fprintf(stderr, "%s: cannot open output\n", options.output_path);
+            trace_close(&trace);
+            return 2;
+        }
+        fprintf(output, "timestamp_s,raw_code,filtered\n");
+    }
+
+    golden_t golden;
+    memset(&golden, 0, sizeof(golden));
+    if (options.golden_path != NULL) {
+        golden.file = fopen(options.golden_path, "r");
+        if (golden.file == NULL) {
+            fprintf(stderr, "%s: cannot open golden file\n", options.golden_path);
+            trace_close(&trace);
+            return 2;
+        }
+    }
+
+    sim_clock_reset();
+    ads1115_set_delay_function(sim_clock_delay_ms);
+    i2c_init(0, 0, REPLAY_I2C_FREQUENCY);
+    if (ads1115_init(REPLAY_I2C_ADDRESS, ADS1115_PGA_4_096V, options.data_rate, ADS1115_MUX_P0_NG) != ADS1115_OK) {
+        fprintf(stderr, "ads1115_init failed\n");
+        return 1;
+    }
+    glucose_filter_init(&options.filter);
+    i2c_sim_clear_stats();
+    profile_init();
+
+    stage_stats_t read_host_ns = { 0 };
+    stage_stats_t read_device_us = { 0 };
+    stage_stats_t filter_host_ns = { 0 };
+    stage_stats_t output_host_ns = { 0 };
+    uint64_t samples = 0;
+    uint32_t first_ts = 0;
+    uint32_t last_ts = 0;
+    int exit_code = 0;
+
+    uint64_t start_ns = host_now_ns();
+    trace_sample_t sample;
+    while ((trace_err = trace_next(&trace, &sample)) == TRACE_OK) {
+        if (samples == 0) {
+            first_ts = sample.timestamp_s;
+        }
+        last_ts = sample.timestamp_s;
+        sim_clock_advance_to_us((uint64_t)(sample.timestamp_s - first_ts) * 1000000);
+        i2c_sim_set_conversion_value(sample.raw_code);
+
+        uint64_t t0_ns = host_now_ns();
+        uint64_t t0_us = sim_clock_now_us();
+        int16_t raw_code;
+        ads1115_ret_code_t err_code = ads1115_read_raw_data(REPLAY_I2C_ADDRESS, &raw_code);
+        uint64_t t1_ns = host_now_ns();
+        if (err_code != ADS1115_OK) {
+            fprintf(stderr, "trace:%u: ads1115_read_raw_data failed (%d)\n", trace.line, (int)err_code);
+            exit_code = 1;
+            break;
+        }
+        if (sample.window_size != 0) {
+            glucose_filter_resize_window(sample.window_size); // Follow the device's level changes
+        }
+        float filtered = glucose_filter_apply(raw_code / options.counts_per_mgdl);
+        uint64_t t2_ns = host_now_ns();
+
+        stage_record(&read_host_ns, t1_ns - t0_ns);
+        stage_record(&read_device_us, sim_clock_now_us() - t0_us);
+        stage_record(&filter_host_ns, t2_ns - t1_ns);
+
+        if (output != NULL) {
+            fprintf(output, "%u,%d,%.9g\n", sample.timestamp_s, raw_code, (double)filtered);
+            stage_record(&output_host_ns, host_now_ns() - t2_ns);
+        }
+        if (golden.file != NULL) {
+            golden_compare(&golden, &sample, filtered, options.tolerance);
+        }
+        samples++;
+    }
+    uint64_t elapsed_ns = host_now_ns() - start_ns;
+
+    if (trace_err == TRACE_ERR_FORMAT) {
+        fprintf(stderr, "%s:%u: malformed trace\n", options.trace_path, trace.line);
+        exit_code = 1;
+    }
+    trace_close(&trace);
+    if (output != NULL && output != stdout) {
+        fclose(output);
+    }
+
+    // Report on stderr so the filtered output can go to stdout
+    double elapsed_s = elapsed_ns / 1e9;
+    double span_s = (samples > 1) ? (double)(last_ts - first_ts) : 0.0;
+    i2c_sim_stats_t bus;
+    i2c_sim_get_stats(&bus);
+
+    fprintf(stderr, "samples                %llu\n", (unsigned long long)samples);
+    fprintf(stderr, "trace span             %.2f h\n", span_s / 3600.0);
+    fprintf(stderr, "wall time              %.3f s\n", elapsed_s);
+    if (elapsed_s > 0.0) {
+        fprintf(stderr, "throughput             %.0f samples/s\n", samples / elapsed_s);
+        fprintf(stderr, "speedup vs real time   %.0fx\n", span_s / elapsed_s);
+    }
+    fprintf(stderr, "I2C transfers/sample   %.1f\n", samples ? (double)bus.transfers / samples : 0.0);
+    fprintf(stderr, "\n%-24s %10s %10s %10s\n", "stage (host ns)", "min", "mean", "max");
+    fprintf(stderr, "%-24s %10llu %10.0f %10llu\n", "ads1115_read_raw_data",
+            (unsigned long long)read_host_ns.min, stage_mean(&read_host_ns), (unsigned long long)read_host_ns.max);
+    fprintf(stderr, "%-24s %10llu %10.0f %10llu\n", "glucose_filter_apply",
+            (unsigned long long)filter_host_ns.min, stage_mean(&filter_host_ns), (unsigned long long)filter_host_ns.max);
+    if (output_host_ns.count > 0) {
+        fprintf(stderr, "%-24s %10llu %10.0f %10llu\n", "output",
+                (unsigned long long)output_host_ns.min, stage_mean(&output_host_ns), (unsigned long long)output_host_ns.max);
+    }
+    fprintf(stderr, "\n%-24s %10s %10s %10s\n", "stage (device us)", "min", "mean", "max");
+    fprintf(stderr, "%-24s %10llu %10.0f %10llu\n", "ads1115_read_raw_data",
+            (unsigned long long)read_device_us.min, stage_mean(&read_device_us), (unsigned long long)read_device_us.max);
+
+#if PROFILE_ENABLED
+    fprintf(stderr, "\n");
+    profile_dump(print_stderr);
+#endif
+
+    if (golden.file != NULL) {
+        uint32_t ts;
+        int raw;
+        double value;
+        if (exit_code == 0 && golden_next(&golden, &ts, &raw, &value)) {
+            golden.length_mismatch = true; // Golden file has more samples than the trace
+        }
+        fclose(golden.file);
+
+        fprintf(stderr, "\ngolden: %llu compared, %llu mismatches, max |diff| %.9g%s\n",
+                (unsigned long long)golden.compared, (unsigned long long)golden.mismatches, golden.max_diff,
+                golden.length_mismatch ? ", sample count differs" : "");
+        if (golden.mismatches > 0 || golden.length_mismatch) {
+            exit_code = 1;
+        }
+    }
+    return exit_code;
+}